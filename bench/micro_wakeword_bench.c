@@ -0,0 +1,528 @@
+// bench/micro_wakeword_bench.c
+// Replays a WAV corpus (or synthetic noise) through the feature generator and
+// detector at full speed and reports throughput and per-call latency
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+#include "micro_wakeword.h"
+#include "tests/wav_reader.h"
+
+#define SAMPLE_RATE 16000
+#define BYTES_PER_CHUNK (160 * 2)  // 10ms @ 16kHz (16-bit mono)
+#define MAX_MODELS 16
+#define MAX_CLIPS 1024
+
+// Per-call latency samples for one API function
+typedef struct {
+	uint64_t *samples;
+	size_t count;
+	size_t capacity;
+	uint64_t total;
+	uint64_t max;
+} LatencyStats;
+
+// Results for one model
+typedef struct {
+	const char *name;
+	bool xnnpack;  // Delegate actually in use
+	double audio_seconds;
+	double wall_seconds;
+	size_t inferences;
+	size_t detections;
+	LatencyStats features;
+	LatencyStats detector;
+	long peak_rss_kb;
+} ModelResult;
+
+// Clip of 16-bit PCM to replay
+typedef struct {
+	char name[600];
+	uint8_t *audio;
+	size_t audio_size;
+	WavFile wav;  // Owns audio unless synthetic
+	bool synthetic;
+} Clip;
+
+static uint64_t now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static long peak_rss_kb(void) {
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+	return usage.ru_maxrss;  // Kilobytes on Linux
+}
+
+static int latency_record(LatencyStats *stats, uint64_t ns) {
+	if (stats->count == stats->capacity) {
+		size_t capacity = stats->capacity ? stats->capacity * 2 : 4096;
+		uint64_t *samples = (uint64_t *)realloc(stats->samples, capacity * sizeof(uint64_t));
+		if (!samples) {
+			return -1;
+		}
+		stats->samples = samples;
+		stats->capacity = capacity;
+	}
+	stats->samples[stats->count++] = ns;
+	stats->total += ns;
+	if (ns > stats->max) {
+		stats->max = ns;
+	}
+	return 0;
+}
+
+static int compare_u64(const void *a, const void *b) {
+	uint64_t x = *(const uint64_t *)a;
+	uint64_t y = *(const uint64_t *)b;
+	return x < y ? -1 : x > y;
+}
+
+// Nearest-rank percentile in microseconds (samples must be sorted)
+static double percentile_us(const LatencyStats *stats, double p) {
+	if (stats->count == 0) {
+		return 0.0;
+	}
+	size_t rank = (size_t)(p * (double)stats->count + 0.999999);
+	if (rank < 1) {
+		rank = 1;
+	}
+	if (rank > stats->count) {
+		rank = stats->count;
+	}
+	return (double)stats->samples[rank - 1] / 1000.0;
+}
+
+// Find the bundled TensorFlow Lite C library
+static const char *find_tflite_lib(void) {
+	const char *paths[] = {
+		"lib/linux_amd64/libtensorflowlite_c.so",
+		"lib/linux_arm64/libtensorflowlite_c.so",
+		"lib/linux_armv7/libtensorflowlite_c.so",
+		"../lib/linux_amd64/libtensorflowlite_c.so",
+		"../lib/linux_arm64/libtensorflowlite_c.so",
+		"../lib/linux_armv7/libtensorflowlite_c.so",
+		NULL
+	};
+
+	for (size_t i = 0; paths[i]; ++i) {
+		FILE *f = fopen(paths[i], "r");
+		if (f) {
+			fclose(f);
+			return paths[i];
+		}
+	}
+	return NULL;
+}
+
+// Read a number that follows "key": in a model's JSON manifest
+static bool json_number(const char *json, const char *key, double *value) {
+	char pattern[64];
+	snprintf(pattern, sizeof(pattern), "\"%s\"", key);
+	const char *p = strstr(json, pattern);
+	if (!p) {
+		return false;
+	}
+	p = strchr(p + strlen(pattern), ':');
+	if (!p) {
+		return false;
+	}
+	char *end;
+	*value = strtod(p + 1, &end);
+	return end != p + 1;
+}
+
+// Fill the detector config for a model from its manifest, if present
+static void load_model_config(const char *models_dir, const char *name,
+			      char *model_path, size_t model_path_size,
+			      MicroWakeWordConfig *config) {
+	snprintf(model_path, model_path_size, "%s/%s.tflite", models_dir, name);
+	config->model_path = model_path;
+	config->probability_cutoff = 0.97f;
+	config->sliding_window_size = 5;
+
+	char json_path[1024];
+	snprintf(json_path, sizeof(json_path), "%s/%s.json", models_dir, name);
+	FILE *f = fopen(json_path, "r");
+	if (!f) {
+		return;
+	}
+	char json[4096];
+	size_t n = fread(json, 1, sizeof(json) - 1, f);
+	fclose(f);
+	json[n] = '\0';
+
+	double value;
+	if (json_number(json, "probability_cutoff", &value)) {
+		config->probability_cutoff = (float)value;
+	}
+	if (json_number(json, "sliding_window_size", &value) && value >= 1) {
+		config->sliding_window_size = (size_t)value;
+	}
+}
+
+static int compare_clips(const void *a, const void *b) {
+	return strcmp(((const Clip *)a)->name, ((const Clip *)b)->name);
+}
+
+// Load every <wav_dir>/<subdir>/*.wav
+static size_t load_wav_corpus(const char *wav_dir, Clip *clips, size_t max_clips) {
+	size_t count = 0;
+	DIR *dir = opendir(wav_dir);
+	if (!dir) {
+		return 0;
+	}
+
+	struct dirent *entry;
+	while ((entry = readdir(dir)) && count < max_clips) {
+		if (entry->d_name[0] == '.') {
+			continue;
+		}
+		char subdir_path[512];
+		snprintf(subdir_path, sizeof(subdir_path), "%s/%s", wav_dir, entry->d_name);
+		DIR *subdir = opendir(subdir_path);
+		if (!subdir) {
+			continue;
+		}
+
+		struct dirent *file;
+		while ((file = readdir(subdir)) && count < max_clips) {
+			size_t len = strlen(file->d_name);
+			if (len < 4 || strcmp(file->d_name + len - 4, ".wav") != 0) {
+				continue;
+			}
+			Clip *clip = &clips[count];
+			snprintf(clip->name, sizeof(clip->name), "%s/%s", entry->d_name, file->d_name);
+
+			char path[1024];
+			snprintf(path, sizeof(path), "%s/%s", subdir_path, file->d_name);
+			if (wav_file_read(path, &clip->wav) != 0) {
+				fprintf(stderr, "Skipping unreadable WAV file: %s\n", path);
+				continue;
+			}
+			clip->audio = (uint8_t *)clip->wav.data;
+			clip->audio_size = clip->wav.data_size;
+			clip->synthetic = false;
+			count++;
+		}
+		closedir(subdir);
+	}
+	closedir(dir);
+
+	qsort(clips, count, sizeof(Clip), compare_clips);
+	return count;
+}
+
+// Deterministic pseudo-random noise
+static int make_synthetic_clip(Clip *clip, double seconds) {
+	size_t num_samples = (size_t)(seconds * SAMPLE_RATE);
+	int16_t *samples = (int16_t *)malloc(num_samples * sizeof(int16_t));
+	if (!samples) {
+		return -1;
+	}
+	uint32_t seed = 12345;
+	for (size_t i = 0; i < num_samples; ++i) {
+		seed = seed * 1103515245u + 12345u;
+		samples[i] = (int16_t)((seed >> 16) & 0x3fff) - 0x2000;
+	}
+	snprintf(clip->name, sizeof(clip->name), "synthetic");
+	clip->audio = (uint8_t *)samples;
+	clip->audio_size = num_samples * sizeof(int16_t);
+	clip->synthetic = true;
+	return 0;
+}
+
+// Replay every clip through one model, timing each library call
+static int bench_model(const MicroWakeWordConfig *config, const Clip *clips, size_t num_clips,
+		       int repeat, ModelResult *result) {
+	MicroWakeWordFeatures *features = micro_wakeword_features_create();
+	MicroWakeWord *mww = micro_wakeword_create(config);
+	if (!features || !mww) {
+		micro_wakeword_features_destroy(features);
+		micro_wakeword_destroy(mww);
+		return -1;
+	}
+
+	result->xnnpack = micro_wakeword_uses_xnnpack(mww);
+
+	uint64_t wall_ns = 0;
+	for (int r = 0; r < repeat; ++r) {
+		for (size_t c = 0; c < num_clips; ++c) {
+			const Clip *clip = &clips[c];
+			micro_wakeword_features_reset(features);
+			micro_wakeword_reset(mww);
+			result->audio_seconds += (double)(clip->audio_size / 2) / SAMPLE_RATE;
+
+			uint64_t clip_start = now_ns();
+			for (size_t offset = 0; offset < clip->audio_size; offset += BYTES_PER_CHUNK) {
+				size_t size = clip->audio_size - offset;
+				if (size > BYTES_PER_CHUNK) {
+					size = BYTES_PER_CHUNK;
+				}
+
+				float *feature_array = NULL;
+				size_t feature_count = 0;
+				uint64_t t0 = now_ns();
+				int status = micro_wakeword_features_process_streaming(
+					features, clip->audio + offset, size, &feature_array, &feature_count);
+				uint64_t t1 = now_ns();
+				if (status != 0 || latency_record(&result->features, t1 - t0) != 0) {
+					free(feature_array);
+					micro_wakeword_features_destroy(features);
+					micro_wakeword_destroy(mww);
+					return -1;
+				}
+
+				for (size_t i = 0; i + MICRO_WAKEWORD_FEATURES_PER_FRAME <= feature_count;
+				     i += MICRO_WAKEWORD_FEATURES_PER_FRAME) {
+					t0 = now_ns();
+					bool detected = micro_wakeword_process_streaming(
+						mww, feature_array + i, MICRO_WAKEWORD_FEATURES_PER_FRAME);
+					t1 = now_ns();
+					latency_record(&result->detector, t1 - t0);
+
+					// An empty stride buffer means this frame completed a window
+					if (micro_wakeword_get_buffer_size(mww) == 0) {
+						result->inferences++;
+					}
+					if (detected) {
+						result->detections++;
+					}
+				}
+				free(feature_array);
+			}
+			wall_ns += now_ns() - clip_start;
+		}
+	}
+
+	result->wall_seconds = (double)wall_ns / 1e9;
+	result->peak_rss_kb = peak_rss_kb();
+
+	micro_wakeword_features_destroy(features);
+	micro_wakeword_destroy(mww);
+
+	qsort(result->features.samples, result->features.count, sizeof(uint64_t), compare_u64);
+	qsort(result->detector.samples, result->detector.count, sizeof(uint64_t), compare_u64);
+	return 0;
+}
+
+static void print_latency(const char *label, const LatencyStats *stats) {
+	printf("  %-32s calls %8zu  p50 %8.2f us  p99 %8.2f us  p999 %8.2f us  max %8.2f us\n",
+	       label, stats->count, percentile_us(stats, 0.50), percentile_us(stats, 0.99),
+	       percentile_us(stats, 0.999), (double)stats->max / 1000.0);
+}
+
+static void write_latency_json(FILE *out, const char *key, const LatencyStats *stats) {
+	fprintf(out,
+		"      \"%s\": {\"calls\": %zu, \"total_us\": %.3f, \"p50_us\": %.3f, "
+		"\"p99_us\": %.3f, \"p999_us\": %.3f, \"max_us\": %.3f}",
+		key, stats->count, (double)stats->total / 1000.0, percentile_us(stats, 0.50),
+		percentile_us(stats, 0.99), percentile_us(stats, 0.999),
+		(double)stats->max / 1000.0);
+}
+
+static void write_json(FILE *out, const char *corpus, size_t num_clips, int repeat,
+		       int num_threads, const ModelResult *results, size_t num_results) {
+	fprintf(out, "{\n");
+	fprintf(out, "  \"corpus\": \"%s\",\n", corpus);
+	fprintf(out, "  \"clips\": %zu,\n", num_clips);
+	fprintf(out, "  \"repeat\": %d,\n", repeat);
+	fprintf(out, "  \"num_threads\": %d,\n", num_threads);
+	fprintf(out, "  \"peak_rss_kb\": %ld,\n", peak_rss_kb());
+	fprintf(out, "  \"models\": [\n");
+	for (size_t i = 0; i < num_results; ++i) {
+		const ModelResult *r = &results[i];
+		double rtf = r->audio_seconds > 0 ? r->wall_seconds / r->audio_seconds : 0.0;
+		fprintf(out, "    {\n");
+		fprintf(out, "      \"name\": \"%s\",\n", r->name);
+		fprintf(out, "      \"xnnpack\": %s,\n", r->xnnpack ? "true" : "false");
+		fprintf(out, "      \"audio_seconds\": %.3f,\n", r->audio_seconds);
+		fprintf(out, "      \"wall_seconds\": %.6f,\n", r->wall_seconds);
+		fprintf(out, "      \"real_time_factor\": %.6f,\n", rtf);
+		fprintf(out, "      \"inferences\": %zu,\n", r->inferences);
+		fprintf(out, "      \"inferences_per_second\": %.1f,\n",
+			r->wall_seconds > 0 ? (double)r->inferences / r->wall_seconds : 0.0);
+		fprintf(out, "      \"detections\": %zu,\n", r->detections);
+		fprintf(out, "      \"peak_rss_kb\": %ld,\n", r->peak_rss_kb);
+		write_latency_json(out, "features_process_streaming", &r->features);
+		fprintf(out, ",\n");
+		write_latency_json(out, "process_streaming", &r->detector);
+		fprintf(out, "\n    }%s\n", i + 1 < num_results ? "," : "");
+	}
+	fprintf(out, "  ]\n}\n");
+}
+
+static void usage(const char *prog) {
+	fprintf(stderr,
+		"Usage: %s [-m model]... [-d models_dir] [-w wav_dir | -s seconds]\n"
+		"          [-r repeat] [-t threads] [-x] [-l libtensorflowlite_c.so] [-j output.json]\n"
+		"  -m  Model name (repeatable, default: all bundled models)\n"
+		"  -d  Directory with <model>.tflite and <model>.json (default: pymicro_wakeword/models)\n"
+		"  -w  Replay <wav_dir>/*/*.wav (default: tests)\n"
+		"  -s  Replay this many seconds of synthetic noise instead of WAV files\n"
+		"  -r  Replay the corpus this many times (default: 1)\n"
+		"  -t  Interpreter threads (default: runtime default)\n"
+		"  -x  Use the XNNPACK delegate\n"
+		"  -l  Path to libtensorflowlite_c (default: auto-detect)\n"
+		"  -j  Write JSON results to this file (- for stdout)\n",
+		prog);
+}
+
+int main(int argc, char *argv[]) {
+	const char *default_models[] = { "okay_nabu", "hey_jarvis", "hey_mycroft", "alexa" };
+	const char *models[MAX_MODELS];
+	size_t num_models = 0;
+	const char *models_dir = "pymicro_wakeword/models";
+	const char *wav_dir = "tests";
+	const char *lib_path = NULL;
+	const char *json_path = NULL;
+	double synthetic_seconds = 0.0;
+	int repeat = 1;
+	int num_threads = 0;
+	bool use_xnnpack = false;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "m:d:w:s:r:t:xl:j:h")) != -1) {
+		switch (opt) {
+		case 'm':
+			if (num_models < MAX_MODELS) {
+				models[num_models++] = optarg;
+			}
+			break;
+		case 'd':
+			models_dir = optarg;
+			break;
+		case 'w':
+			wav_dir = optarg;
+			break;
+		case 's':
+			synthetic_seconds = atof(optarg);
+			break;
+		case 'r':
+			repeat = atoi(optarg);
+			break;
+		case 't':
+			num_threads = atoi(optarg);
+			break;
+		case 'x':
+			use_xnnpack = true;
+			break;
+		case 'l':
+			lib_path = optarg;
+			break;
+		case 'j':
+			json_path = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+	if (repeat < 1) {
+		repeat = 1;
+	}
+	if (!lib_path) {
+		lib_path = find_tflite_lib();
+	}
+	if (num_models == 0) {
+		for (size_t i = 0; i < sizeof(default_models) / sizeof(default_models[0]); ++i) {
+			models[num_models++] = default_models[i];
+		}
+	}
+
+	// Load the corpus once, outside the timed region
+	static Clip clips[MAX_CLIPS];
+	size_t num_clips = 0;
+	const char *corpus = wav_dir;
+	if (synthetic_seconds <= 0.0) {
+		num_clips = load_wav_corpus(wav_dir, clips, MAX_CLIPS);
+		if (num_clips == 0) {
+			fprintf(stderr, "No WAV files under %s, using 60s of synthetic noise\n", wav_dir);
+			synthetic_seconds = 60.0;
+		}
+	}
+	if (num_clips == 0) {
+		if (make_synthetic_clip(&clips[0], synthetic_seconds) != 0) {
+			fprintf(stderr, "Failed to allocate synthetic audio\n");
+			return 1;
+		}
+		num_clips = 1;
+		corpus = "synthetic";
+	}
+
+	ModelResult results[MAX_MODELS];
+	memset(results, 0, sizeof(results));
+	size_t num_results = 0;
+	int failures = 0;
+
+	for (size_t m = 0; m < num_models; ++m) {
+		char model_path[512];
+		MicroWakeWordConfig config = {
+			.libtensorflowlite_c = lib_path,
+			.num_threads = num_threads,
+			.use_xnnpack = use_xnnpack
+		};
+		load_model_config(models_dir, models[m], model_path, sizeof(model_path), &config);
+
+		ModelResult *result = &results[num_results];
+		result->name = models[m];
+		if (bench_model(&config, clips, num_clips, repeat, result) != 0) {
+			fprintf(stderr, "Failed to benchmark model %s (%s)\n", models[m], model_path);
+			free(result->features.samples);
+			free(result->detector.samples);
+			memset(result, 0, sizeof(*result));
+			failures++;
+			continue;
+		}
+		num_results++;
+
+		double rtf = result->audio_seconds > 0 ? result->wall_seconds / result->audio_seconds : 0.0;
+		printf("%s%s: %.1fs of audio in %.3fs (RTF %.5f, %.0fx real time), "
+		       "%zu inferences (%.0f/s), %zu detections, peak RSS %ld KB\n",
+		       result->name, result->xnnpack ? " (XNNPACK)" : "", result->audio_seconds, result->wall_seconds, rtf,
+		       rtf > 0 ? 1.0 / rtf : 0.0, result->inferences,
+		       result->wall_seconds > 0 ? (double)result->inferences / result->wall_seconds : 0.0,
+		       result->detections, result->peak_rss_kb);
+		print_latency("features_process_streaming", &result->features);
+		print_latency("process_streaming", &result->detector);
+	}
+
+	if (json_path) {
+		FILE *out = strcmp(json_path, "-") == 0 ? stdout : fopen(json_path, "w");
+		if (!out) {
+			fprintf(stderr, "Failed to open %s\n", json_path);
+			failures++;
+		} else {
+			write_json(out, corpus, num_clips, repeat, num_threads, results, num_results);
+			if (out != stdout) {
+				fclose(out);
+			}
+		}
+	}
+
+	for (size_t i = 0; i < num_results; ++i) {
+		free(results[i].features.samples);
+		free(results[i].detector.samples);
+	}
+	for (size_t i = 0; i < num_clips; ++i) {
+		if (clips[i].synthetic) {
+			free(clips[i].audio);
+		} else {
+			wav_file_free(&clips[i].wav);
+		}
+	}
+
+	return failures ? 1 : 0;
+}
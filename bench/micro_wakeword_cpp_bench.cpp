@@ -0,0 +1,189 @@
+// bench/micro_wakeword_cpp_bench.cpp
+// Compares heap allocations and time per frame of the micro_wakeword.hpp
+// callback path with copying frames through std::vector
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+#include "micro_wakeword.hpp"
+
+// Linked with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc, which counts
+// allocations made by this program and the static libraries. operator new is
+// replaced below, so this also counts the TensorFlow Lite runtime's own
+// allocations; those are reported separately.
+static size_t g_allocations = 0;
+
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) {
+	g_allocations++;
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+	g_allocations++;
+	return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+	g_allocations++;
+	return __real_realloc(ptr, size);
+}
+}
+
+// Route operator new through the counted malloc
+void *operator new(size_t size) {
+	void *ptr = malloc(size ? size : 1);
+	if (!ptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void operator delete(void *ptr) noexcept {
+	free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+	free(ptr);
+}
+
+#define SAMPLE_RATE 16000
+#define CHUNK_BYTES 320  // 10ms
+
+// Find the bundled TensorFlow Lite C library
+static const char *find_tflite_lib() {
+	const char *paths[] = {
+		"lib/linux_amd64/libtensorflowlite_c.so",
+		"lib/linux_arm64/libtensorflowlite_c.so",
+		"lib/linux_armv7/libtensorflowlite_c.so",
+		"../lib/linux_amd64/libtensorflowlite_c.so",
+		"../lib/linux_arm64/libtensorflowlite_c.so",
+		"../lib/linux_armv7/libtensorflowlite_c.so",
+		nullptr
+	};
+
+	for (size_t i = 0; paths[i]; ++i) {
+		FILE *f = fopen(paths[i], "r");
+		if (f) {
+			fclose(f);
+			return paths[i];
+		}
+	}
+	return nullptr;
+}
+
+struct Result {
+	size_t frames;
+	size_t allocations;           // Everything outside the detector
+	size_t detector_allocations;  // Inside micro_wakeword_process_streaming
+	double seconds;
+};
+
+// Feed one frame, keeping allocations made by the runtime apart
+static void detect(micro_wakeword::Detector &mww, const float *frame, size_t size,
+		   Result &result) {
+	size_t start_allocations = g_allocations;
+	micro_wakeword_process_streaming(mww.get(), frame, size);
+	result.detector_allocations += g_allocations - start_allocations;
+	result.frames++;
+}
+
+// Frames copied out of the feature generator into vectors, the way the
+// C++ example used to wrap the C API
+static Result run_vectors(micro_wakeword::Detector &mww, const std::vector<uint8_t> &audio) {
+	micro_wakeword::Features features;
+	Result result = { 0, 0, 0, 0.0 };
+	size_t start_allocations = g_allocations;
+	auto start = std::chrono::steady_clock::now();
+
+	for (size_t pos = 0; pos + CHUNK_BYTES <= audio.size(); pos += CHUNK_BYTES) {
+		float *out = nullptr;
+		size_t out_size = 0;
+		if (micro_wakeword_features_process_streaming(features.get(), audio.data() + pos,
+							      CHUNK_BYTES, &out, &out_size) != 0) {
+			throw micro_wakeword::Error("Failed to process features");
+		}
+		std::vector<float> all(out, out + out_size);
+		free(out);
+
+		for (size_t i = 0; i < all.size(); i += MICRO_WAKEWORD_FEATURES_PER_FRAME) {
+			std::vector<float> frame(all.begin() + i,
+						 all.begin() + i + MICRO_WAKEWORD_FEATURES_PER_FRAME);
+			detect(mww, frame.data(), frame.size(), result);
+		}
+	}
+
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	result.allocations = g_allocations - start_allocations - result.detector_allocations;
+	return result;
+}
+
+// Frames handed straight from the feature generator to the detector
+static Result run_callbacks(micro_wakeword::Detector &mww, const std::vector<uint8_t> &audio) {
+	micro_wakeword::Features features;
+	Result result = { 0, 0, 0, 0.0 };
+	size_t start_allocations = g_allocations;
+	auto start = std::chrono::steady_clock::now();
+
+	for (size_t pos = 0; pos + CHUNK_BYTES <= audio.size(); pos += CHUNK_BYTES) {
+		features.process(micro_wakeword::Span<const uint8_t>(audio.data() + pos, CHUNK_BYTES),
+				 [&](micro_wakeword::Span<const float> frame, uint64_t) {
+			detect(mww, frame.data(), frame.size(), result);
+		});
+	}
+
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	result.allocations = g_allocations - start_allocations - result.detector_allocations;
+	return result;
+}
+
+static void report(const char *name, const Result &result) {
+	double frames = result.frames ? (double)result.frames : 1.0;
+	printf("%-10s %8zu frames  %6.2f allocations/frame (+%.2f in the runtime)  %8.0f ns/frame\n",
+	       name, result.frames, (double)result.allocations / frames,
+	       (double)result.detector_allocations / frames, result.seconds * 1e9 / frames);
+}
+
+int main(int argc, char *argv[]) {
+	const char *model_path = argc > 1 ? argv[1] : "pymicro_wakeword/models/okay_nabu.tflite";
+	double seconds = argc > 2 ? atof(argv[2]) : 30.0;
+
+	MicroWakeWordConfig config = {};
+	config.model_path = model_path;
+	config.libtensorflowlite_c = argc > 3 ? argv[3] : find_tflite_lib();
+	config.probability_cutoff = 0.97f;
+	config.sliding_window_size = 5;
+
+	// Deterministic low-level noise
+	std::vector<uint8_t> audio((size_t)(seconds * SAMPLE_RATE) * sizeof(int16_t));
+	uint32_t seed = 1;
+	for (size_t i = 0; i + 1 < audio.size(); i += 2) {
+		seed = seed * 1664525u + 1013904223u;
+		int16_t sample = (int16_t)((int32_t)(seed >> 16) % 2000 - 1000);
+		memcpy(&audio[i], &sample, sizeof(sample));
+	}
+
+	try {
+		micro_wakeword::Detector mww(config);
+		printf("%s, %.0fs of audio in 10ms chunks\n", model_path, seconds);
+
+		Result vectors = run_vectors(mww, audio);
+		mww.reset();
+		Result callbacks = run_callbacks(mww, audio);
+
+		report("vectors", vectors);
+		report("callbacks", callbacks);
+	} catch (const std::exception &e) {
+		fprintf(stderr, "Error: %s\n", e.what());
+		return 1;
+	}
+
+	return 0;
+}
@@ -45,36 +45,20 @@ int main(int argc, char *argv[]) {
 	bool detected = false;
 
 	while ((bytes_read = fread(audio_buffer, 1, sizeof(audio_buffer), stdin)) > 0) {
-		// Generate features
-		float *feature_array = NULL;
-		size_t feature_count = 0;
-		int result = micro_wakeword_features_process_streaming(
-			features, audio_buffer, bytes_read, &feature_array, &feature_count);
+		// Generate features and run the detector on each frame
+		MicroWakeWordDetection detection;
+		int result = micro_wakeword_process_audio(mww, features, audio_buffer, bytes_read,
+							  &detection, 1);
 
-		if (result != 0) {
-			fprintf(stderr, "Failed to process features\n");
+		if (result < 0) {
+			fprintf(stderr, "Failed to process audio\n");
 			break;
 		}
 
-		// Process each feature window
-		// The feature array contains features in a flat format
-		// For microWakeWord, each window has 40 features
-		if (feature_array && feature_count > 0) {
-			size_t features_per_window = 40;
-			for (size_t i = 0; i < feature_count; i += features_per_window) {
-				if (i + features_per_window <= feature_count) {
-					if (micro_wakeword_process_streaming(
-						mww, &feature_array[i], features_per_window)) {
-						printf("Wake word detected!\n");
-						detected = true;
-						break;
-					}
-				}
-			}
-			free(feature_array);
-		}
-
-		if (detected) {
+		if (result > 0) {
+			printf("Wake word detected at %.2fs!\n",
+			       (double)detection.sample_offset / 16000.0);
+			detected = true;
 			break;
 		}
 	}
@@ -9,6 +9,12 @@
 extern "C" {
 #endif
 
+// Number of features in one frame (10ms of audio)
+#define MICRO_WAKEWORD_FEATURES_PER_FRAME 40
+
+// Audio a feature generator keeps buffered between calls at most (80ms)
+#define MICRO_WAKEWORD_FEATURES_BACKLOG_BYTES 2560
+
 // Opaque handle for the wake word detector instance
 typedef struct MicroWakeWord MicroWakeWord;
 
@@ -20,13 +26,44 @@ typedef struct {
 	const char *model_path;           // Path to .tflite model file
 	const char *libtensorflowlite_c;  // Path to libtensorflowlite_c.so (optional, NULL for default)
 	float probability_cutoff;         // Detection threshold (0.0-1.0)
-	size_t sliding_window_size;       // Number of probabilities to average
+	size_t sliding_window_size;       // Number of probabilities to average (> 0)
+	int32_t num_threads;              // Interpreter threads (0 for the runtime default)
+	bool use_xnnpack;                 // Run through the XNNPACK CPU delegate if available
+	uint32_t model_id;                // Caller's identifier, reported with results (optional)
+	uint32_t refractory_ms;           // No detections for this long after one (0 for none)
+	uint32_t refractory_steps;        // No detections for this many inferences after one (0 for none)
+	float rearm_cutoff;               // After a detection, wait for the mean to fall to this
+					  // before the next one (0 to disable, < probability_cutoff)
 } MicroWakeWordConfig;
 
 // Create a new wake word detector instance
+// After a detection, further detections are held back until refractory_ms
+// (of stream position) and refractory_steps (inferences) have passed and,
+// if rearm_cutoff is set, the sliding window mean has fallen to
+// rearm_cutoff. Inference keeps running meanwhile, so the detector does not
+// need to be reset between detections.
 // Returns NULL on error
 MicroWakeWord *micro_wakeword_create(const MicroWakeWordConfig *config);
 
+// Create a new wake word detector from a .tflite flatbuffer in memory
+// config->model_path is ignored. The buffer is not copied and must stay
+// valid and unmodified until every detector created from it is destroyed.
+// Returns NULL on error
+MicroWakeWord *micro_wakeword_create_from_buffer(const MicroWakeWordConfig *config,
+						 const void *model_data,
+						 size_t model_size);
+
+// Create a new wake word detector from a .tflite flatbuffer stored at
+// offset in a file (e.g. a packed asset file). The region is memory-mapped
+// read-only and shared, so detectors and processes mapping the same file
+// share its pages. size 0 maps to the end of the file. offset should be
+// 16-byte aligned. config->model_path is ignored.
+// Returns NULL on error
+MicroWakeWord *micro_wakeword_create_from_mmap(const MicroWakeWordConfig *config,
+					       const char *path,
+					       size_t offset,
+					       size_t size);
+
 // Process audio features and return true if wake word is detected
 // features: pointer to feature array (1D, size should match model input)
 // features_size: number of features
@@ -36,7 +73,50 @@ bool micro_wakeword_process_streaming(MicroWakeWord *mww,
 				       const float *features,
 				       size_t features_size);
 
+// Outcome of running one frame through a detector
+typedef struct {
+	uint64_t sample_offset;   // Stream position (in samples) at the end of the frame
+	float probability;        // Latest model output (0 before the first inference)
+	float mean_probability;   // Mean over the sliding window
+	float peak_probability;   // Highest probability in the sliding window
+	uint32_t model_id;        // config->model_id of the detector
+	uint32_t inferences;      // Model runs on this frame: 0 while a window fills,
+				  // more than 1 when an energy gate replays skipped windows
+	bool detected;            // Mean probability crossed the cutoff on this frame
+} MicroWakeWordResult;
+
+// Process one frame of features and report the outcome
+// result: filled in on success (may be NULL)
+// Returns 1 if the wake word is detected, 0 if not, or a negative error:
+//   -1 invalid arguments or no model loaded
+//   -2 features_size does not match the model's frame size
+//   -3 copying into the input tensor failed
+//   -4 inference failed
+//   -5 reading the output tensor failed
+// Note: The detector's sample position advances by 10ms (160 samples) per
+// frame; micro_wakeword_process_audio sets it from the feature generator
+int micro_wakeword_process_frame(MicroWakeWord *mww,
+				 const float *features,
+				 size_t features_size,
+				 MicroWakeWordResult *result);
+
+// Same as micro_wakeword_process_frame for a frame ending at stream position
+// end_sample, e.g. the end_sample passed to a MicroWakeWordFrameCallback
+int micro_wakeword_process_frame_at(MicroWakeWord *mww,
+				    const float *features,
+				    size_t features_size,
+				    uint64_t end_sample,
+				    MicroWakeWordResult *result);
+
+// Stream position (in samples) at the end of the last frame the detector
+// processed, counted from its creation or last reset
+uint64_t micro_wakeword_get_sample_position(MicroWakeWord *mww);
+
 // Reset the wake word detector state
+// Restores the initial streaming state without reloading the model file:
+// variable tensors are restored from a snapshot taken at creation, or the
+// interpreter is rebuilt from the already parsed model when the model keeps
+// its state in resource variables
 void micro_wakeword_reset(MicroWakeWord *mww);
 
 // Get quantization parameters (for debugging)
@@ -46,15 +126,131 @@ void micro_wakeword_get_quantization_params(MicroWakeWord *mww,
 					    float *output_scale,
 					    int32_t *output_zero_point);
 
+// Whether the interpreter runs through the XNNPACK delegate. False if it
+// was not requested, or the runtime lacks the delegate or it rejected the
+// model, in which case the built-in kernels are used.
+bool micro_wakeword_uses_xnnpack(MicroWakeWord *mww);
+
 // Get buffer size (for debugging)
 size_t micro_wakeword_get_buffer_size(MicroWakeWord *mww);
 
 // Get probability information (for debugging)
 // Returns the number of probabilities in the window
+// Note: The mean comes from a running sum and may differ from re-summing the
+// window in float by up to 1e-4 (for windows up to 1000 entries)
 size_t micro_wakeword_get_probabilities(MicroWakeWord *mww,
 					float *latest_prob,
 					float *mean_prob);
 
+// Time spent in one processing stage (CLOCK_MONOTONIC nanoseconds)
+typedef struct {
+	uint64_t count;     // Times the stage ran
+	uint64_t total_ns;  // Cumulative time
+	uint64_t max_ns;    // Longest single run
+} MicroWakeWordStageStats;
+
+// Performance counters of a detector
+typedef struct {
+	uint64_t frames;         // Frames passed to the detector
+	uint64_t inferences;     // Interpreter invocations
+	uint64_t detections;     // Inferences that reported a detection
+	uint64_t suppressed;     // Inferences above the cutoff held back by refractory_ms,
+				 // refractory_steps or rearm_cutoff
+	uint64_t resets;         // micro_wakeword_reset calls
+	size_t buffered_frames;  // Frames staged toward the next window (current)
+	MicroWakeWordStageStats quantize;  // Quantizing frames into the input tensor
+	MicroWakeWordStageStats invoke;    // TfLiteInterpreterInvoke
+} MicroWakeWordStats;
+
+// Start (enable true) or stop collecting performance counters
+// Counters are cleared whenever collection is started. While disabled, which
+// is the default, the streaming path only pays for one predictable branch
+// per stage.
+void micro_wakeword_enable_stats(MicroWakeWord *mww, bool enable);
+
+// Get the counters collected since micro_wakeword_enable_stats
+// Returns 0 on success, non-zero on error
+int micro_wakeword_get_stats(MicroWakeWord *mww, MicroWakeWordStats *stats);
+
+// Energy gate settings (see micro_wakeword_set_energy_gate)
+typedef struct {
+	float threshold;          // Frame energy above the noise floor that opens the gate (> 0)
+	size_t hangover_frames;   // Frames the gate stays open once energy drops (0 for 50)
+	size_t preroll_windows;   // Skipped windows replayed when the gate opens (0 for 64;
+				  // raised to sliding_window_size if smaller)
+} MicroWakeWordEnergyGate;
+
+// Energy gate counters
+typedef struct {
+	uint64_t windows;   // Windows completed while the gate was set
+	uint64_t skipped;   // Windows not run through the model when completed
+	uint64_t replayed;  // Skipped windows run later, when the gate opened
+	size_t pending;     // Skipped windows currently kept for replay
+	float noise_floor;  // Current noise floor estimate
+	bool open;          // Whether the gate is open
+} MicroWakeWordEnergyGateStats;
+
+// Let the detector skip inference while the input is quiet, or disable the
+// gate (config NULL). Frame energy is the mean of a frame's features and is
+// compared with an adaptive noise floor. The gate opens on a frame more
+// than threshold above the floor and stays open for hangover_frames after
+// the last one. While closed, completed windows are quantized and kept
+// instead of being run, up to a capacity of
+// max(preroll_windows or 64, sliding_window_size) with the oldest dropped.
+// When the gate opens they are run through the model first. The streaming
+// state and probability window then match a detector without the gate
+// exactly if no more than capacity windows were skipped in a row. After a
+// longer run they still match only if the model's streaming state reaches
+// back no more than capacity windows. For the bundled models that holds
+// with the default capacity. Detections on replayed windows are not reported.
+// Replacing or disabling the gate drops any kept windows.
+// Returns 0 on success, non-zero on error
+int micro_wakeword_set_energy_gate(MicroWakeWord *mww, const MicroWakeWordEnergyGate *config);
+
+// Get the energy gate counters
+// Returns 0 on success, non-zero on error or if no gate is set
+int micro_wakeword_get_energy_gate_stats(MicroWakeWord *mww,
+					 MicroWakeWordEnergyGateStats *stats);
+
+// One model output recorded by the probability tap
+typedef struct {
+	uint64_t sequence;       // Outputs recorded or dropped before this one (gaps mark drops)
+	uint64_t sample_offset;  // Stream position (in samples) at the end of the window
+	uint64_t timestamp_ns;   // CLOCK_MONOTONIC time (ns) when the output was recorded
+	float probability;       // Raw model output, before the sliding window
+} MicroWakeWordProbability;
+
+// Probability tap counters
+typedef struct {
+	size_t capacity;   // Entries the ring holds
+	uint64_t written;  // Entries recorded since the tap was set
+	uint64_t dropped;  // Entries lost because the ring was full
+	size_t pending;    // Entries waiting to be read
+} MicroWakeWordProbabilityTapStats;
+
+// Record every model output, with its stream position, in a lock-free ring
+// of at least capacity entries (rounded up to a power of two), or remove
+// the tap (capacity 0). One other thread may drain it with
+// micro_wakeword_read_probabilities while this detector processes audio;
+// neither side ever blocks. When the ring is full new outputs are dropped
+// and counted. Outputs replayed by an energy gate are recorded too.
+// micro_wakeword_reset does not clear the ring. Must not be called while
+// the detector is processing or the ring is being read.
+// Returns 0 on success, non-zero on error
+int micro_wakeword_set_probability_tap(MicroWakeWord *mww, size_t capacity);
+
+// Move up to max_entries of the oldest recorded outputs into entries.
+// Safe to call from one thread concurrently with processing.
+// Returns the number of entries copied (0 if there is no tap)
+size_t micro_wakeword_read_probabilities(MicroWakeWord *mww,
+					 MicroWakeWordProbability *entries,
+					 size_t max_entries);
+
+// Get the probability tap counters (safe from any thread)
+// Returns 0 on success, non-zero on error or if no tap is set
+int micro_wakeword_get_probability_tap_stats(MicroWakeWord *mww,
+					     MicroWakeWordProbabilityTapStats *stats);
+
 // Destroy the wake word detector instance and free all resources
 void micro_wakeword_destroy(MicroWakeWord *mww);
 
@@ -76,12 +272,226 @@ int micro_wakeword_features_process_streaming(
 	float **features_out,
 	size_t *features_size_out);
 
+// Same as micro_wakeword_features_process_streaming, but writes into a
+// caller-owned buffer instead of allocating one
+// features_out: room for max_frames * MICRO_WAKEWORD_FEATURES_PER_FRAME floats
+// max_frames: capacity of features_out in frames
+// Returns the number of frames written, or negative on error
+// Note: Audio that did not fit stays buffered; pass audio_size 0 (audio_bytes
+// may be NULL) to drain it. At most one frame is produced per 10ms of audio.
+// Fails without consuming anything if more than
+// MICRO_WAKEWORD_FEATURES_BACKLOG_BYTES would be left buffered.
+int micro_wakeword_features_process_streaming_into(
+	MicroWakeWordFeatures *features,
+	const uint8_t *audio_bytes,
+	size_t audio_size,
+	float *features_out,
+	size_t max_frames);
+
+// Receives each frame from micro_wakeword_features_process_streaming_callback
+// frame: MICRO_WAKEWORD_FEATURES_PER_FRAME features, valid only during the call
+// end_sample: stream position (in samples) at the end of the frame
+// Returns 0 to continue, negative to stop with that error
+typedef int (*MicroWakeWordFrameCallback)(void *user_data, const float *frame,
+					  uint64_t end_sample);
+
+// Same as micro_wakeword_features_process_streaming, but hands each frame to
+// callback as it is produced instead of copying it out
+// Returns the number of frames produced, or negative on error (including a
+// negative value returned by callback)
+int micro_wakeword_features_process_streaming_callback(
+	MicroWakeWordFeatures *features,
+	const uint8_t *audio_bytes,
+	size_t audio_size,
+	MicroWakeWordFrameCallback callback,
+	void *user_data);
+
+// Performance counters of a feature generator
+typedef struct {
+	uint64_t audio_bytes;       // Audio bytes passed in
+	uint64_t frames;            // Frames produced
+	uint64_t resets;            // micro_wakeword_features_reset calls
+	size_t buffered_bytes;      // Audio held in the backlog (current)
+	size_t max_buffered_bytes;  // Largest backlog seen at the end of a call
+	MicroWakeWordStageStats frontend;  // micro_frontend_process_samples, per chunk
+} MicroWakeWordFeaturesStats;
+
+// Start (enable true) or stop collecting performance counters; see
+// micro_wakeword_enable_stats
+void micro_wakeword_features_enable_stats(MicroWakeWordFeatures *features, bool enable);
+
+// Get the counters collected since micro_wakeword_features_enable_stats
+// Returns 0 on success, non-zero on error
+int micro_wakeword_features_get_stats(MicroWakeWordFeatures *features,
+				      MicroWakeWordFeaturesStats *stats);
+
+// Samples run through the frontend since creation or the last reset
+// (buffered audio that has not made a frame yet is not counted)
+uint64_t micro_wakeword_features_get_sample_position(MicroWakeWordFeatures *features);
+
 // Reset the feature generator state
 void micro_wakeword_features_reset(MicroWakeWordFeatures *features);
 
 // Destroy the feature generator instance and free all resources
 void micro_wakeword_features_destroy(MicroWakeWordFeatures *features);
 
+// Wake word detection reported by micro_wakeword_process_audio
+typedef struct {
+	uint64_t sample_offset;  // Stream position (in samples) at the end of the triggering frame
+	float probability;       // Mean probability over the sliding window
+	float peak_probability;  // Highest probability in the sliding window
+	uint32_t model_id;       // config->model_id of the detector
+} MicroWakeWordDetection;
+
+// Run raw audio through the feature generator and the detector in one call
+// audio_bytes: pointer to 16-bit PCM audio data (16kHz, mono)
+// audio_size: size in bytes
+// detections: receives up to max_detections detections, oldest first
+// Returns the number of detections (may exceed max_detections, in which case
+// only the first max_detections are stored), or negative on error
+// Note: Sample offsets count from the creation or last reset of features.
+// The detector is not reset after a detection, as with
+// micro_wakeword_process_streaming.
+int micro_wakeword_process_audio(MicroWakeWord *mww,
+				 MicroWakeWordFeatures *features,
+				 const uint8_t *audio_bytes,
+				 size_t audio_size,
+				 MicroWakeWordDetection *detections,
+				 size_t max_detections);
+
+// Options for micro_wakeword_scan_audio and micro_wakeword_scan_file
+typedef struct {
+	size_t num_threads;     // Worker threads for segments (0 = number of online CPUs)
+	float segment_seconds;  // Audio per segment (0 = no segmenting, one exact pass)
+	float warmup_seconds;   // Audio run before each segment and not reported (0 for 3)
+} MicroWakeWordScanOptions;
+
+// Scan a whole recording for the wake word. By default the recording runs
+// through one feature generator and detector created from config, and the
+// results are exactly those of a single micro_wakeword_process_audio pass.
+// Setting segment_seconds trades that exactness for parallelism: the audio is
+// split into segments run on num_threads threads, each preceded by
+// warmup_seconds of the audio before it. The model's streaming state is
+// rebuilt exactly by the warm-up, but the frontend's noise reduction and gain
+// control adapt over long time constants, so probabilities near a segment
+// start can differ by a few output steps (1/256) and a detection that close to
+// probability_cutoff can appear or disappear. To use every core on a corpus
+// without that trade-off, scan several recordings in parallel instead.
+// audio_bytes: 16-bit PCM audio data (16kHz, mono)
+// options: NULL for defaults
+// detections_out: receives a malloc'd array of detections in stream order,
+// with sample offsets from the start of the audio (caller must free; NULL if
+// there are none)
+// Returns 0 on success, non-zero on error
+int micro_wakeword_scan_audio(const MicroWakeWordConfig *config,
+			      const uint8_t *audio_bytes,
+			      size_t audio_size,
+			      const MicroWakeWordScanOptions *options,
+			      MicroWakeWordDetection **detections_out,
+			      size_t *num_detections_out);
+
+// Same as micro_wakeword_scan_audio for a file, which is memory-mapped
+// rather than read. Takes a WAV file (16-bit PCM, 16kHz, mono) or, for any
+// file without a RIFF header, raw 16-bit PCM. Sample offsets count from the
+// start of the audio data.
+// Returns 0 on success, non-zero on error
+int micro_wakeword_scan_file(const MicroWakeWordConfig *config,
+			     const char *path,
+			     const MicroWakeWordScanOptions *options,
+			     MicroWakeWordDetection **detections_out,
+			     size_t *num_detections_out);
+
+// Opaque handle for several wake word models sharing one feature generator
+typedef struct MicroWakeWordMulti MicroWakeWordMulti;
+
+// Most models a MicroWakeWordMulti can run
+#define MICRO_WAKEWORD_MULTI_MAX_MODELS 8
+
+// Per-model hits from one micro_wakeword_multi_process_audio call, indexed
+// like the configs passed to micro_wakeword_multi_create
+typedef struct {
+	size_t num_models;
+	size_t detections[MICRO_WAKEWORD_MULTI_MAX_MODELS];  // Detections per model
+	MicroWakeWordDetection first[MICRO_WAKEWORD_MULTI_MAX_MODELS];  // First detection per model
+} MicroWakeWordMultiResult;
+
+// Create one detector per config, all fed from a single feature generator
+// Each model keeps its own stride, cutoff and sliding window
+// num_models: 1 to MICRO_WAKEWORD_MULTI_MAX_MODELS
+// Returns NULL on error
+MicroWakeWordMulti *micro_wakeword_multi_create(const MicroWakeWordConfig *configs,
+						size_t num_models);
+
+// Run raw audio through the shared feature generator and every model
+// audio_bytes: pointer to 16-bit PCM audio data (16kHz, mono)
+// audio_size: size in bytes
+// result: receives the per-model hits of this call
+// Returns the total number of detections, or negative on error. A model
+// failing on a frame does not stop the others: every model still sees every
+// frame, result holds their hits, and the first error is returned.
+// Note: Features are computed once per frame whatever the number of models.
+// Detectors are not reset after a detection.
+int micro_wakeword_multi_process_audio(MicroWakeWordMulti *multi,
+				       const uint8_t *audio_bytes,
+				       size_t audio_size,
+				       MicroWakeWordMultiResult *result);
+
+// Detector of the index-th model (owned by multi), or NULL
+MicroWakeWord *micro_wakeword_multi_get_detector(MicroWakeWordMulti *multi, size_t index);
+
+// Reset the feature generator and every detector
+void micro_wakeword_multi_reset(MicroWakeWordMulti *multi);
+
+// Destroy the multi-model detector and all its detectors
+void micro_wakeword_multi_destroy(MicroWakeWordMulti *multi);
+
+// Opaque handle for a multi-stream detector engine
+typedef struct MicroWakeWordEngine MicroWakeWordEngine;
+
+// Opaque handle for a stream registered with an engine
+typedef struct MicroWakeWordStream MicroWakeWordStream;
+
+// Called from an engine worker thread when a stream detects its wake word.
+// Whether the detector is then reset depends on the stream's config; see
+// micro_wakeword_engine_add_stream.
+typedef void (*MicroWakeWordDetectionCallback)(MicroWakeWordStream *stream,
+					       void *user_data);
+
+// Create an engine with a fixed pool of worker threads
+// num_threads: number of workers (0 = number of online CPUs)
+// Returns NULL on error
+MicroWakeWordEngine *micro_wakeword_engine_create(size_t num_threads);
+
+// Register a stream with its own feature generator and detector
+// callback: invoked on detection (optional), with user_data. If config sets
+// no refractory_ms, refractory_steps or rearm_cutoff, the detector is reset
+// after each detection; otherwise it keeps running and holds back repeats.
+// Returns NULL on error
+MicroWakeWordStream *micro_wakeword_engine_add_stream(MicroWakeWordEngine *engine,
+						      const MicroWakeWordConfig *config,
+						      MicroWakeWordDetectionCallback callback,
+						      void *user_data);
+
+// Queue 16-bit PCM audio (16kHz, mono) for a stream; safe to call from any
+// thread. Audio is copied and processed asynchronously by the worker pool,
+// at most one worker at a time per stream, in push order.
+// Returns 0 on success, non-zero on error
+int micro_wakeword_engine_push_audio(MicroWakeWordStream *stream,
+				     const uint8_t *audio_bytes,
+				     size_t audio_size);
+
+// Unregister a stream and free it. Unprocessed audio is dropped; blocks
+// until no worker is using the stream.
+void micro_wakeword_engine_remove_stream(MicroWakeWordStream *stream);
+
+// Block until all audio queued so far has been processed
+void micro_wakeword_engine_flush(MicroWakeWordEngine *engine);
+
+// Stop the worker threads and free the engine and all remaining streams.
+// Unprocessed audio is dropped; call micro_wakeword_engine_flush first to
+// finish it.
+void micro_wakeword_engine_destroy(MicroWakeWordEngine *engine);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,386 @@
+// include/micro_wakeword.hpp
+// Header-only C++ interface to the micro_wakeword library (C++11 or later)
+//
+// Detector and Features own their C handles and are move-only. Inputs are
+// taken as Span views, so any contiguous buffer (array, std::vector,
+// std::array, std::span) can be passed without copying. Feature frames go
+// from the feature generator to callbacks and detectors without
+// intermediate containers.
+
+#ifndef MICRO_WAKEWORD_HPP_
+#define MICRO_WAKEWORD_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "micro_wakeword.h"
+
+namespace micro_wakeword {
+
+// Non-owning view of a contiguous sequence, like C++20 std::span
+template <typename T>
+class Span {
+public:
+	Span() noexcept : data_(nullptr), size_(0) {}
+	Span(T *data, size_t size) noexcept : data_(data), size_(size) {}
+
+	template <size_t N>
+	Span(T (&array)[N]) noexcept : data_(array), size_(N) {}
+
+	// Any container with data() and size(), e.g. std::vector or std::span.
+	// Only lvalues: a Span built from a temporary would dangle.
+	template <typename Container,
+		  typename = typename std::enable_if<
+			  !std::is_array<Container>::value &&
+			  std::is_convertible<decltype(std::declval<Container &>().data()),
+					      T *>::value>::type>
+	Span(Container &container) noexcept
+		: data_(container.data()), size_(container.size()) {}
+
+	T *data() const noexcept { return data_; }
+	size_t size() const noexcept { return size_; }
+	bool empty() const noexcept { return size_ == 0; }
+	T *begin() const noexcept { return data_; }
+	T *end() const noexcept { return data_ + size_; }
+	T &operator[](size_t i) const noexcept { return data_[i]; }
+
+private:
+	T *data_;
+	size_t size_;
+};
+
+// Thrown when a C API call fails; code() is its return value
+class Error : public std::runtime_error {
+public:
+	Error(const std::string &what, int code = -1)
+		: std::runtime_error(what), code_(code) {}
+
+	int code() const noexcept { return code_; }
+
+private:
+	int code_;
+};
+
+// Latest probability and sliding window mean
+struct Probabilities {
+	float latest;
+	float mean;
+	size_t count;  // Probabilities in the window
+};
+
+// Feature generator: 16-bit PCM audio (16kHz, mono) in, 40-feature frames out
+class Features {
+public:
+	Features() : handle_(micro_wakeword_features_create()) {
+		if (!handle_) {
+			throw Error("Failed to create feature generator");
+		}
+	}
+
+	// Take ownership of a handle from micro_wakeword_features_create
+	explicit Features(MicroWakeWordFeatures *handle) : handle_(handle) {
+		if (!handle_) {
+			throw Error("Invalid feature generator handle");
+		}
+	}
+
+	~Features() { micro_wakeword_features_destroy(handle_); }
+
+	Features(const Features &) = delete;
+	Features &operator=(const Features &) = delete;
+
+	Features(Features &&other) noexcept : handle_(other.handle_) {
+		other.handle_ = nullptr;
+	}
+
+	Features &operator=(Features &&other) noexcept {
+		if (this != &other) {
+			micro_wakeword_features_destroy(handle_);
+			handle_ = other.handle_;
+			other.handle_ = nullptr;
+		}
+		return *this;
+	}
+
+	// Generate frames from audio, calling
+	//   on_frame(Span<const float> frame, uint64_t end_sample)
+	// for each one. frame is only valid during the call; end_sample is the
+	// stream position at the end of the frame. Exceptions thrown by
+	// on_frame stop processing and are rethrown.
+	// Returns the number of frames produced
+	template <typename OnFrame>
+	size_t process(Span<const uint8_t> audio, OnFrame &&on_frame) {
+		FrameContext<OnFrame> context(on_frame);
+		int result = micro_wakeword_features_process_streaming_callback(
+			handle_, audio.data(), audio.size(), &frame_trampoline<OnFrame>, &context);
+		if (context.error) {
+			std::rethrow_exception(context.error);
+		}
+		if (result < 0) {
+			throw Error("Failed to process features", result);
+		}
+		return static_cast<size_t>(result);
+	}
+
+	template <typename OnFrame>
+	size_t process(Span<const int16_t> samples, OnFrame &&on_frame) {
+		return process(as_bytes(samples), std::forward<OnFrame>(on_frame));
+	}
+
+	// Generate frames into a caller-owned buffer of
+	// max_frames * MICRO_WAKEWORD_FEATURES_PER_FRAME floats
+	// Returns the number of frames written
+	size_t process_into(Span<const uint8_t> audio, Span<float> frames) {
+		int result = micro_wakeword_features_process_streaming_into(
+			handle_, audio.data(), audio.size(), frames.data(),
+			frames.size() / MICRO_WAKEWORD_FEATURES_PER_FRAME);
+		if (result < 0) {
+			throw Error("Failed to process features", result);
+		}
+		return static_cast<size_t>(result);
+	}
+
+	// Samples run through the frontend since creation or reset
+	uint64_t sample_position() const {
+		return micro_wakeword_features_get_sample_position(handle_);
+	}
+
+	void reset() { micro_wakeword_features_reset(handle_); }
+
+	void enable_stats(bool enable) { micro_wakeword_features_enable_stats(handle_, enable); }
+
+	MicroWakeWordFeaturesStats stats() const {
+		MicroWakeWordFeaturesStats stats;
+		int result = micro_wakeword_features_get_stats(handle_, &stats);
+		if (result != 0) {
+			throw Error("Failed to get feature statistics", result);
+		}
+		return stats;
+	}
+
+	MicroWakeWordFeatures *get() const noexcept { return handle_; }
+
+	// Give up ownership of the handle
+	MicroWakeWordFeatures *release() noexcept {
+		MicroWakeWordFeatures *handle = handle_;
+		handle_ = nullptr;
+		return handle;
+	}
+
+	static Span<const uint8_t> as_bytes(Span<const int16_t> samples) noexcept {
+		return Span<const uint8_t>(reinterpret_cast<const uint8_t *>(samples.data()),
+					   samples.size() * sizeof(int16_t));
+	}
+
+private:
+	template <typename OnFrame>
+	struct FrameContext {
+		explicit FrameContext(OnFrame &on_frame) : on_frame(on_frame) {}
+		OnFrame &on_frame;
+		std::exception_ptr error;
+	};
+
+	// Exceptions must not unwind through the C library
+	template <typename OnFrame>
+	static int frame_trampoline(void *user_data, const float *frame, uint64_t end_sample) {
+		FrameContext<OnFrame> *context = static_cast<FrameContext<OnFrame> *>(user_data);
+		try {
+			context->on_frame(Span<const float>(frame, MICRO_WAKEWORD_FEATURES_PER_FRAME),
+					  end_sample);
+		} catch (...) {
+			context->error = std::current_exception();
+			return -5;
+		}
+		return 0;
+	}
+
+	MicroWakeWordFeatures *handle_;
+};
+
+// Wake word detector for one model
+class Detector {
+public:
+	explicit Detector(const MicroWakeWordConfig &config)
+		: Detector(micro_wakeword_create(&config)) {}
+
+	// Model from memory that must outlive the detector; see
+	// micro_wakeword_create_from_buffer
+	Detector(const MicroWakeWordConfig &config, Span<const uint8_t> model)
+		: Detector(micro_wakeword_create_from_buffer(&config, model.data(), model.size())) {}
+
+	// Take ownership of a handle from micro_wakeword_create*
+	explicit Detector(MicroWakeWord *handle) : handle_(handle) {
+		if (!handle_) {
+			throw Error("Failed to create wake word detector");
+		}
+	}
+
+	// Model memory-mapped from part of a file; see micro_wakeword_create_from_mmap
+	static Detector from_mmap(const MicroWakeWordConfig &config, const char *path,
+				  size_t offset = 0, size_t size = 0) {
+		return Detector(micro_wakeword_create_from_mmap(&config, path, offset, size));
+	}
+
+	~Detector() { micro_wakeword_destroy(handle_); }
+
+	Detector(const Detector &) = delete;
+	Detector &operator=(const Detector &) = delete;
+
+	Detector(Detector &&other) noexcept : handle_(other.handle_) {
+		other.handle_ = nullptr;
+	}
+
+	Detector &operator=(Detector &&other) noexcept {
+		if (this != &other) {
+			micro_wakeword_destroy(handle_);
+			handle_ = other.handle_;
+			other.handle_ = nullptr;
+		}
+		return *this;
+	}
+
+	// Feed one frame; returns true if the wake word was detected
+	bool process(Span<const float> frame) {
+		return micro_wakeword_process_streaming(handle_, frame.data(), frame.size());
+	}
+
+	// Feed one frame and report its outcome
+	MicroWakeWordResult process_frame(Span<const float> frame) {
+		MicroWakeWordResult result;
+		int status = micro_wakeword_process_frame(handle_, frame.data(), frame.size(), &result);
+		if (status < 0) {
+			throw Error("Failed to process frame", status);
+		}
+		return result;
+	}
+
+	// Same, for a frame ending at stream position end_sample
+	MicroWakeWordResult process_frame(Span<const float> frame, uint64_t end_sample) {
+		MicroWakeWordResult result;
+		int status = micro_wakeword_process_frame_at(handle_, frame.data(), frame.size(),
+							     end_sample, &result);
+		if (status < 0) {
+			throw Error("Failed to process frame", status);
+		}
+		return result;
+	}
+
+	// Stream position at the end of the last frame
+	uint64_t sample_position() const { return micro_wakeword_get_sample_position(handle_); }
+
+	// Run audio through features and this detector, calling
+	//   on_detection(const MicroWakeWordDetection &detection)
+	// for each detection. The detector is not reset after a detection.
+	// Returns the number of detections
+	template <typename OnDetection>
+	size_t process_audio(Features &features, Span<const uint8_t> audio,
+			     OnDetection &&on_detection) {
+		size_t detections = 0;
+		MicroWakeWordDetection detection;
+		features.process(audio, [&](Span<const float> frame, uint64_t end_sample) {
+			MicroWakeWordResult result = process_frame(frame, end_sample);
+			if (result.detected) {
+				detection.sample_offset = result.sample_offset;
+				detection.probability = result.mean_probability;
+				detection.peak_probability = result.peak_probability;
+				detection.model_id = result.model_id;
+				detections++;
+				on_detection(detection);
+			}
+		});
+		return detections;
+	}
+
+	template <typename OnDetection>
+	size_t process_audio(Features &features, Span<const int16_t> samples,
+			     OnDetection &&on_detection) {
+		return process_audio(features, Features::as_bytes(samples),
+				     std::forward<OnDetection>(on_detection));
+	}
+
+	void reset() { micro_wakeword_reset(handle_); }
+
+	Probabilities probabilities() const {
+		Probabilities probabilities;
+		probabilities.count = micro_wakeword_get_probabilities(handle_, &probabilities.latest,
+									&probabilities.mean);
+		return probabilities;
+	}
+
+	size_t buffer_size() const { return micro_wakeword_get_buffer_size(handle_); }
+
+	bool uses_xnnpack() const { return micro_wakeword_uses_xnnpack(handle_); }
+
+	// Enable or disable the energy gate (nullptr disables it)
+	void set_energy_gate(const MicroWakeWordEnergyGate *config) {
+		int result = micro_wakeword_set_energy_gate(handle_, config);
+		if (result != 0) {
+			throw Error("Failed to set energy gate", result);
+		}
+	}
+
+	MicroWakeWordEnergyGateStats energy_gate_stats() const {
+		MicroWakeWordEnergyGateStats stats;
+		int result = micro_wakeword_get_energy_gate_stats(handle_, &stats);
+		if (result != 0) {
+			throw Error("Failed to get energy gate statistics", result);
+		}
+		return stats;
+	}
+
+	// Record every model output in a lock-free ring of at least capacity
+	// entries, or remove it (0); see micro_wakeword_set_probability_tap
+	void set_probability_tap(size_t capacity) {
+		int result = micro_wakeword_set_probability_tap(handle_, capacity);
+		if (result != 0) {
+			throw Error("Failed to set probability tap", result);
+		}
+	}
+
+	// Move the oldest recorded outputs into entries; may run on one other
+	// thread while this detector processes audio.
+	// Returns the number of entries filled
+	size_t read_probabilities(Span<MicroWakeWordProbability> entries) {
+		return micro_wakeword_read_probabilities(handle_, entries.data(), entries.size());
+	}
+
+	MicroWakeWordProbabilityTapStats probability_tap_stats() const {
+		MicroWakeWordProbabilityTapStats stats;
+		int result = micro_wakeword_get_probability_tap_stats(handle_, &stats);
+		if (result != 0) {
+			throw Error("Failed to get probability tap statistics", result);
+		}
+		return stats;
+	}
+
+	void enable_stats(bool enable) { micro_wakeword_enable_stats(handle_, enable); }
+
+	MicroWakeWordStats stats() const {
+		MicroWakeWordStats stats;
+		int result = micro_wakeword_get_stats(handle_, &stats);
+		if (result != 0) {
+			throw Error("Failed to get detector statistics", result);
+		}
+		return stats;
+	}
+
+	MicroWakeWord *get() const noexcept { return handle_; }
+
+	// Give up ownership of the handle
+	MicroWakeWord *release() noexcept {
+		MicroWakeWord *handle = handle_;
+		handle_ = nullptr;
+		return handle;
+	}
+
+private:
+	MicroWakeWord *handle_;
+};
+
+}  // namespace micro_wakeword
+
+#endif  // MICRO_WAKEWORD_HPP_
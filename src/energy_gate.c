@@ -0,0 +1,110 @@
+// src/energy_gate.c
+// Energy gate that lets a detector skip inference on quiet audio
+#include "energy_gate.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_HANGOVER_FRAMES 50  // 500ms
+#define DEFAULT_PREROLL_WINDOWS 64  // Covers the bundled models' receptive fields
+
+// The floor follows drops in energy within a few frames but rises over
+// seconds, so speech does not pull it up while steady noise eventually does
+#define FLOOR_FALL_RATE 0.1f
+#define FLOOR_RISE_RATE 0.001f
+
+int energy_gate_init(EnergyGate *gate, const MicroWakeWordEnergyGate *config,
+		     size_t window_bytes, size_t min_windows) {
+	memset(gate, 0, sizeof(*gate));
+	if (!(config->threshold > 0.0f) || window_bytes == 0) {
+		return -1;
+	}
+
+	gate->threshold = config->threshold;
+	gate->hangover_frames = config->hangover_frames ? config->hangover_frames
+							: DEFAULT_HANGOVER_FRAMES;
+	gate->capacity = config->preroll_windows ? config->preroll_windows
+						  : DEFAULT_PREROLL_WINDOWS;
+	if (gate->capacity < min_windows) {
+		gate->capacity = min_windows;
+	}
+	gate->window_bytes = window_bytes;
+
+	// Kept windows plus the resume slot in one block
+	gate->windows = (uint8_t *)malloc((gate->capacity + 1) * window_bytes);
+	if (!gate->windows) {
+		return -2;
+	}
+	gate->resume = gate->windows + gate->capacity * window_bytes;
+
+	energy_gate_reset(gate);
+	return 0;
+}
+
+void energy_gate_free(EnergyGate *gate) {
+	free(gate->windows);
+	gate->windows = NULL;
+	gate->resume = NULL;
+	gate->capacity = 0;
+	gate->count = 0;
+}
+
+void energy_gate_reset(EnergyGate *gate) {
+	energy_gate_clear(gate);
+	gate->hangover_left = gate->hangover_frames;
+	gate->window_open = false;
+}
+
+void energy_gate_add_frame(EnergyGate *gate, const float *features, size_t n) {
+	float energy = 0.0f;
+	for (size_t i = 0; i < n; ++i) {
+		energy += features[i];
+	}
+	energy /= (float)n;
+
+	if (!gate->floor_valid) {
+		gate->noise_floor = energy;
+		gate->floor_valid = true;
+	}
+
+	if (energy > gate->noise_floor + gate->threshold) {
+		gate->hangover_left = gate->hangover_frames;
+	} else if (gate->hangover_left > 0) {
+		gate->hangover_left--;
+	}
+	if (gate->hangover_left > 0) {
+		gate->window_open = true;
+	}
+
+	float rate = energy < gate->noise_floor ? FLOOR_FALL_RATE : FLOOR_RISE_RATE;
+	gate->noise_floor += (energy - gate->noise_floor) * rate;
+}
+
+bool energy_gate_end_window(EnergyGate *gate) {
+	bool open = gate->window_open;
+	gate->window_open = false;
+	gate->total_windows++;
+	return open;
+}
+
+void energy_gate_push(EnergyGate *gate, const uint8_t *window) {
+	size_t slot;
+	if (gate->count < gate->capacity) {
+		slot = (gate->head + gate->count) % gate->capacity;
+		gate->count++;
+	} else {
+		slot = gate->head;
+		gate->head = (gate->head + 1) % gate->capacity;
+	}
+	memcpy(gate->windows + slot * gate->window_bytes, window, gate->window_bytes);
+}
+
+const uint8_t *energy_gate_window(const EnergyGate *gate, size_t index) {
+	size_t slot = (gate->head + index) % gate->capacity;
+	return gate->windows + slot * gate->window_bytes;
+}
+
+void energy_gate_clear(EnergyGate *gate) {
+	gate->head = 0;
+	gate->count = 0;
+}
@@ -0,0 +1,63 @@
+// src/energy_gate.h
+// Energy gate that lets a detector skip inference on quiet audio (internal)
+
+#ifndef ENERGY_GATE_H_
+#define ENERGY_GATE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "micro_wakeword.h"
+
+// Tracks an adaptive noise floor of the frame energy (mean of the frame's
+// features) and keeps the quantized windows skipped while closed, so they
+// can be replayed through the model when the gate opens again
+typedef struct {
+	float threshold;         // Energy above the floor that opens the gate
+	size_t hangover_frames;  // Frames the gate stays open once energy drops
+	size_t hangover_left;
+	float noise_floor;
+	bool floor_valid;        // false until the first frame
+	bool window_open;        // Any frame of the current window kept the gate open
+
+	// Skipped windows, oldest first starting at head
+	uint8_t *windows;
+	size_t window_bytes;
+	size_t capacity;
+	size_t head;
+	size_t count;
+	uint8_t *resume;  // Window that reopened the gate, held during replay
+
+	uint64_t total_windows;
+	uint64_t skipped;
+	uint64_t replayed;
+} EnergyGate;
+
+// Set up a gate for windows of window_bytes quantized features, keeping at
+// least min_windows skipped windows for replay
+// Returns 0 on success, negative on error
+int energy_gate_init(EnergyGate *gate, const MicroWakeWordEnergyGate *config,
+		     size_t window_bytes, size_t min_windows);
+
+// Free the gate's buffers
+void energy_gate_free(EnergyGate *gate);
+
+// Drop skipped windows and reopen the gate (the noise floor is kept)
+void energy_gate_reset(EnergyGate *gate);
+
+// Account one frame of features toward the current window
+void energy_gate_add_frame(EnergyGate *gate, const float *features, size_t n);
+
+// Whether the window just completed should be run, then start the next one
+bool energy_gate_end_window(EnergyGate *gate);
+
+// Keep a skipped window for replay, evicting the oldest when full
+void energy_gate_push(EnergyGate *gate, const uint8_t *window);
+
+// index-th kept window, oldest first (index < gate->count)
+const uint8_t *energy_gate_window(const EnergyGate *gate, size_t index);
+
+// Forget the kept windows
+void energy_gate_clear(EnergyGate *gate);
+
+#endif  // ENERGY_GATE_H_
@@ -0,0 +1,519 @@
+// src/micro_wakeword_engine.c
+// Multi-stream detector engine with a work-stealing worker pool
+#include "micro_wakeword.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Constants
+#define BYTES_PER_CHUNK 320  // 10ms @ 16kHz, 16-bit mono
+#define ENGINE_QUANTUM_BYTES (32 * BYTES_PER_CHUNK)  // Max audio per scheduling turn
+#define ENGINE_QUANTUM_FRAMES (ENGINE_QUANTUM_BYTES / BYTES_PER_CHUNK)
+#define FEATURES_PER_WINDOW MICRO_WAKEWORD_FEATURES_PER_FRAME
+
+// Double-ended run queue of scheduled streams, one per worker
+typedef struct {
+	pthread_mutex_t lock;
+	MicroWakeWordStream **items;
+	size_t head;
+	size_t count;
+	size_t capacity;
+} RunQueue;
+
+// Worker thread
+typedef struct {
+	MicroWakeWordEngine *engine;
+	size_t index;
+	pthread_t thread;
+	bool started;  // Thread is running and must be joined
+	RunQueue queue;
+	uint8_t *audio;   // Scratch for one quantum of audio
+	float *features;  // Scratch for the feature frames of one quantum
+} EngineWorker;
+
+// Stream registered with the engine
+struct MicroWakeWordStream {
+	MicroWakeWordEngine *engine;
+	MicroWakeWordStream *next;  // Engine stream list
+	MicroWakeWordFeatures *features;
+	MicroWakeWord *mww;
+	MicroWakeWordDetectionCallback callback;
+	void *user_data;
+	bool reset_on_detection;  // No refractory period or re-arm cutoff configured
+
+	// Pending audio and scheduling state, protected by lock
+	pthread_mutex_t lock;
+	pthread_cond_t idle;
+	uint8_t *pending;
+	size_t pending_size;
+	size_t pending_capacity;
+	bool scheduled;  // Queued or being processed by a worker
+	bool removed;
+};
+
+// MicroWakeWordEngine structure
+struct MicroWakeWordEngine {
+	EngineWorker *workers;
+	size_t num_workers;
+	size_t next_worker;  // Round-robin target for pushes from outside the pool
+
+	// Protected by lock
+	pthread_mutex_t lock;
+	pthread_cond_t work_available;
+	pthread_cond_t all_idle;
+	size_t queued;  // Streams sitting in run queues
+	size_t active;  // Streams queued or being processed
+	bool shutdown;
+	MicroWakeWordStream *streams;
+};
+
+// Worker running on the current thread, if any
+static __thread EngineWorker *current_worker = NULL;
+
+// Initialize run queue
+static int run_queue_init(RunQueue *queue) {
+	queue->capacity = 16;
+	queue->items = (MicroWakeWordStream **)malloc(queue->capacity * sizeof(*queue->items));
+	if (!queue->items) {
+		return -1;
+	}
+	queue->head = 0;
+	queue->count = 0;
+	pthread_mutex_init(&queue->lock, NULL);
+	return 0;
+}
+
+// Free run queue
+static void run_queue_free(RunQueue *queue) {
+	pthread_mutex_destroy(&queue->lock);
+	free(queue->items);
+}
+
+// Append stream at the back of the queue
+static int run_queue_push(RunQueue *queue, MicroWakeWordStream *stream) {
+	pthread_mutex_lock(&queue->lock);
+
+	if (queue->count == queue->capacity) {
+		size_t new_capacity = queue->capacity * 2;
+		MicroWakeWordStream **items = (MicroWakeWordStream **)malloc(
+			new_capacity * sizeof(*items));
+		if (!items) {
+			pthread_mutex_unlock(&queue->lock);
+			return -1;
+		}
+		for (size_t i = 0; i < queue->count; ++i) {
+			items[i] = queue->items[(queue->head + i) % queue->capacity];
+		}
+		free(queue->items);
+		queue->items = items;
+		queue->head = 0;
+		queue->capacity = new_capacity;
+	}
+
+	queue->items[(queue->head + queue->count) % queue->capacity] = stream;
+	queue->count++;
+
+	pthread_mutex_unlock(&queue->lock);
+	return 0;
+}
+
+// Take stream from the front (owner) or the back (thief) of the queue
+static MicroWakeWordStream *run_queue_pop(RunQueue *queue, bool steal) {
+	pthread_mutex_lock(&queue->lock);
+
+	MicroWakeWordStream *stream = NULL;
+	if (queue->count > 0) {
+		if (steal) {
+			stream = queue->items[(queue->head + queue->count - 1) % queue->capacity];
+		} else {
+			stream = queue->items[queue->head];
+			queue->head = (queue->head + 1) % queue->capacity;
+		}
+		queue->count--;
+	}
+
+	pthread_mutex_unlock(&queue->lock);
+	return stream;
+}
+
+// Put stream on a run queue. Workers reschedule onto their own queue,
+// other threads spread streams round-robin.
+static int schedule_stream(MicroWakeWordEngine *engine, MicroWakeWordStream *stream) {
+	EngineWorker *worker = current_worker;
+	if (!worker || worker->engine != engine) {
+		pthread_mutex_lock(&engine->lock);
+		worker = &engine->workers[engine->next_worker];
+		engine->next_worker = (engine->next_worker + 1) % engine->num_workers;
+		pthread_mutex_unlock(&engine->lock);
+	}
+
+	if (run_queue_push(&worker->queue, stream) != 0) {
+		return -1;
+	}
+
+	pthread_mutex_lock(&engine->lock);
+	engine->queued++;
+	pthread_cond_signal(&engine->work_available);
+	pthread_mutex_unlock(&engine->lock);
+	return 0;
+}
+
+// Mark stream as no longer scheduled (stream lock held)
+static void stream_set_idle(MicroWakeWordStream *stream) {
+	MicroWakeWordEngine *engine = stream->engine;
+
+	stream->scheduled = false;
+	pthread_cond_broadcast(&stream->idle);
+
+	pthread_mutex_lock(&engine->lock);
+	if (--engine->active == 0) {
+		pthread_cond_broadcast(&engine->all_idle);
+	}
+	pthread_mutex_unlock(&engine->lock);
+}
+
+// Run features and detector over audio, reporting detections
+static void process_audio(EngineWorker *worker, MicroWakeWordStream *stream, size_t size) {
+	// Less than one chunk stays buffered between turns, so a quantum never
+	// yields more than ENGINE_QUANTUM_FRAMES frames
+	int frames = micro_wakeword_features_process_streaming_into(
+		stream->features, worker->audio, size, worker->features, ENGINE_QUANTUM_FRAMES);
+
+	for (int f = 0; f < frames; ++f) {
+		// A frame whose inference fails reports no detection
+		if (micro_wakeword_process_frame(stream->mww, worker->features + f * FEATURES_PER_WINDOW,
+						 FEATURES_PER_WINDOW, NULL) != 1) {
+			continue;
+		}
+		if (stream->callback) {
+			stream->callback(stream, stream->user_data);
+		}
+		// Without a refractory period or re-arm cutoff, start listening
+		// again from a clean state so the same utterance is not reported
+		// repeatedly. Otherwise the detector holds back repeats and keeps
+		// its state.
+		if (stream->reset_on_detection) {
+			micro_wakeword_reset(stream->mww);
+		}
+	}
+}
+
+// Process one quantum of a stream's audio, then requeue it if more is pending
+static void run_stream(EngineWorker *worker, MicroWakeWordStream *stream) {
+	pthread_mutex_lock(&stream->lock);
+	size_t size = stream->pending_size;
+	if (size > ENGINE_QUANTUM_BYTES) {
+		size = ENGINE_QUANTUM_BYTES;
+	}
+	memcpy(worker->audio, stream->pending, size);
+	memmove(stream->pending, stream->pending + size, stream->pending_size - size);
+	stream->pending_size -= size;
+	bool removed = stream->removed;
+	pthread_mutex_unlock(&stream->lock);
+
+	if (!removed) {
+		process_audio(worker, stream, size);
+	}
+
+	pthread_mutex_lock(&stream->lock);
+	if (stream->pending_size > 0 && !stream->removed &&
+	    schedule_stream(worker->engine, stream) == 0) {
+		pthread_mutex_unlock(&stream->lock);
+		return;
+	}
+	stream_set_idle(stream);
+	pthread_mutex_unlock(&stream->lock);
+}
+
+// Find work: own queue first, then steal from the others
+static MicroWakeWordStream *find_work(EngineWorker *worker) {
+	MicroWakeWordEngine *engine = worker->engine;
+
+	MicroWakeWordStream *stream = run_queue_pop(&worker->queue, false);
+	for (size_t i = 1; !stream && i < engine->num_workers; ++i) {
+		EngineWorker *victim = &engine->workers[(worker->index + i) % engine->num_workers];
+		stream = run_queue_pop(&victim->queue, true);
+	}
+	return stream;
+}
+
+// Worker thread main loop
+static void *worker_main(void *arg) {
+	EngineWorker *worker = (EngineWorker *)arg;
+	MicroWakeWordEngine *engine = worker->engine;
+	current_worker = worker;
+
+	for (;;) {
+		pthread_mutex_lock(&engine->lock);
+		while (engine->queued == 0 && !engine->shutdown) {
+			pthread_cond_wait(&engine->work_available, &engine->lock);
+		}
+		if (engine->shutdown) {
+			pthread_mutex_unlock(&engine->lock);
+			break;
+		}
+		// Claim one queued stream before looking for it, so other workers
+		// keep waiting instead of chasing a stream that is already taken
+		engine->queued--;
+		pthread_mutex_unlock(&engine->lock);
+
+		// Streams are queued before they are counted, so at least one is
+		// waiting for every claim. A scan can still miss it while other
+		// workers pop concurrently; then look again.
+		MicroWakeWordStream *stream;
+		while (!(stream = find_work(worker))) {
+			sched_yield();
+		}
+
+		run_stream(worker, stream);
+	}
+
+	return NULL;
+}
+
+// Allocate worker scratch and run queue
+static int worker_init(EngineWorker *worker) {
+	worker->audio = (uint8_t *)malloc(ENGINE_QUANTUM_BYTES);
+	worker->features = (float *)malloc(ENGINE_QUANTUM_FRAMES * FEATURES_PER_WINDOW *
+					   sizeof(float));
+	if (!worker->audio || !worker->features) {
+		return -1;
+	}
+	return run_queue_init(&worker->queue);
+}
+
+// Free worker scratch
+static void worker_free(EngineWorker *worker) {
+	free(worker->audio);
+	free(worker->features);
+}
+
+// Free stream resources
+static void stream_free(MicroWakeWordStream *stream) {
+	micro_wakeword_destroy(stream->mww);
+	micro_wakeword_features_destroy(stream->features);
+	pthread_cond_destroy(&stream->idle);
+	pthread_mutex_destroy(&stream->lock);
+	free(stream->pending);
+	free(stream);
+}
+
+MicroWakeWordEngine *micro_wakeword_engine_create(size_t num_threads) {
+	if (num_threads == 0) {
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		num_threads = (cpus > 0) ? (size_t)cpus : 1;
+	}
+
+	MicroWakeWordEngine *engine = (MicroWakeWordEngine *)calloc(1, sizeof(MicroWakeWordEngine));
+	if (!engine) {
+		return NULL;
+	}
+
+	engine->workers = (EngineWorker *)calloc(num_threads, sizeof(EngineWorker));
+	if (!engine->workers) {
+		free(engine);
+		return NULL;
+	}
+
+	pthread_mutex_init(&engine->lock, NULL);
+	pthread_cond_init(&engine->work_available, NULL);
+	pthread_cond_init(&engine->all_idle, NULL);
+
+	// Set up all queues before any thread can steal from them
+	for (size_t i = 0; i < num_threads; ++i) {
+		EngineWorker *worker = &engine->workers[i];
+		worker->engine = engine;
+		worker->index = i;
+		if (worker_init(worker) != 0) {
+			worker_free(worker);
+			engine->num_workers = i;
+			micro_wakeword_engine_destroy(engine);
+			return NULL;
+		}
+		engine->num_workers = i + 1;
+	}
+
+	for (size_t i = 0; i < num_threads; ++i) {
+		EngineWorker *worker = &engine->workers[i];
+		if (pthread_create(&worker->thread, NULL, worker_main, worker) != 0) {
+			// Stops and joins the workers already started
+			micro_wakeword_engine_destroy(engine);
+			return NULL;
+		}
+		worker->started = true;
+	}
+
+	return engine;
+}
+
+MicroWakeWordStream *micro_wakeword_engine_add_stream(MicroWakeWordEngine *engine,
+						      const MicroWakeWordConfig *config,
+						      MicroWakeWordDetectionCallback callback,
+						      void *user_data) {
+	if (!engine || !config) {
+		return NULL;
+	}
+
+	MicroWakeWordStream *stream = (MicroWakeWordStream *)calloc(1, sizeof(MicroWakeWordStream));
+	if (!stream) {
+		return NULL;
+	}
+
+	stream->engine = engine;
+	stream->callback = callback;
+	stream->user_data = user_data;
+
+	stream->features = micro_wakeword_features_create();
+	if (!stream->features) {
+		free(stream);
+		return NULL;
+	}
+
+	stream->mww = micro_wakeword_create(config);
+	stream->reset_on_detection = config->refractory_ms == 0 && config->refractory_steps == 0 &&
+				     config->rearm_cutoff == 0.0f;
+	if (!stream->mww) {
+		micro_wakeword_features_destroy(stream->features);
+		free(stream);
+		return NULL;
+	}
+
+	pthread_mutex_init(&stream->lock, NULL);
+	pthread_cond_init(&stream->idle, NULL);
+
+	pthread_mutex_lock(&engine->lock);
+	stream->next = engine->streams;
+	engine->streams = stream;
+	pthread_mutex_unlock(&engine->lock);
+
+	return stream;
+}
+
+int micro_wakeword_engine_push_audio(MicroWakeWordStream *stream,
+				     const uint8_t *audio_bytes,
+				     size_t audio_size) {
+	if (!stream || (!audio_bytes && audio_size > 0)) {
+		return -1;
+	}
+
+	pthread_mutex_lock(&stream->lock);
+
+	if (stream->removed) {
+		pthread_mutex_unlock(&stream->lock);
+		return -1;
+	}
+
+	// Append to pending audio
+	if (stream->pending_size + audio_size > stream->pending_capacity) {
+		size_t new_capacity = stream->pending_capacity ? stream->pending_capacity * 2 : 4096;
+		while (new_capacity < stream->pending_size + audio_size) {
+			new_capacity *= 2;
+		}
+		uint8_t *pending = (uint8_t *)realloc(stream->pending, new_capacity);
+		if (!pending) {
+			pthread_mutex_unlock(&stream->lock);
+			return -2;
+		}
+		stream->pending = pending;
+		stream->pending_capacity = new_capacity;
+	}
+	memcpy(stream->pending + stream->pending_size, audio_bytes, audio_size);
+	stream->pending_size += audio_size;
+
+	// Hand the stream to the pool unless a worker already owns it
+	if (!stream->scheduled && stream->pending_size > 0) {
+		MicroWakeWordEngine *engine = stream->engine;
+		pthread_mutex_lock(&engine->lock);
+		engine->active++;
+		pthread_mutex_unlock(&engine->lock);
+
+		stream->scheduled = true;
+		if (schedule_stream(engine, stream) != 0) {
+			stream_set_idle(stream);
+			pthread_mutex_unlock(&stream->lock);
+			return -3;
+		}
+	}
+
+	pthread_mutex_unlock(&stream->lock);
+	return 0;
+}
+
+void micro_wakeword_engine_remove_stream(MicroWakeWordStream *stream) {
+	if (!stream) {
+		return;
+	}
+
+	MicroWakeWordEngine *engine = stream->engine;
+
+	// Drop pending audio and wait for any worker to let go of the stream
+	pthread_mutex_lock(&stream->lock);
+	stream->removed = true;
+	stream->pending_size = 0;
+	while (stream->scheduled) {
+		pthread_cond_wait(&stream->idle, &stream->lock);
+	}
+	pthread_mutex_unlock(&stream->lock);
+
+	pthread_mutex_lock(&engine->lock);
+	for (MicroWakeWordStream **link = &engine->streams; *link; link = &(*link)->next) {
+		if (*link == stream) {
+			*link = stream->next;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&engine->lock);
+
+	stream_free(stream);
+}
+
+void micro_wakeword_engine_flush(MicroWakeWordEngine *engine) {
+	if (!engine) {
+		return;
+	}
+
+	pthread_mutex_lock(&engine->lock);
+	while (engine->active > 0) {
+		pthread_cond_wait(&engine->all_idle, &engine->lock);
+	}
+	pthread_mutex_unlock(&engine->lock);
+}
+
+void micro_wakeword_engine_destroy(MicroWakeWordEngine *engine) {
+	if (!engine) {
+		return;
+	}
+
+	// Stop workers; audio still queued is dropped
+	pthread_mutex_lock(&engine->lock);
+	engine->shutdown = true;
+	pthread_cond_broadcast(&engine->work_available);
+	pthread_mutex_unlock(&engine->lock);
+
+	for (size_t i = 0; i < engine->num_workers; ++i) {
+		if (engine->workers[i].started) {
+			pthread_join(engine->workers[i].thread, NULL);
+		}
+	}
+
+	MicroWakeWordStream *stream = engine->streams;
+	while (stream) {
+		MicroWakeWordStream *next = stream->next;
+		stream_free(stream);
+		stream = next;
+	}
+
+	for (size_t i = 0; i < engine->num_workers; ++i) {
+		run_queue_free(&engine->workers[i].queue);
+		worker_free(&engine->workers[i]);
+	}
+
+	pthread_cond_destroy(&engine->all_idle);
+	pthread_cond_destroy(&engine->work_available);
+	pthread_mutex_destroy(&engine->lock);
+	free(engine->workers);
+	free(engine);
+}
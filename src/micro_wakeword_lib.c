@@ -1,7 +1,6 @@
 // src/micro_wakeword_lib.c
 #include "micro_wakeword.h"
 
-#include <dlfcn.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -12,277 +11,258 @@
 // Include micro_features for feature extraction
 #include "micro_features.h"
 
+#include "tflite_runtime.h"
+#include "model_cache.h"
+#include "quantize.h"
+#include "probability_window.h"
+#include "stats.h"
+#include "energy_gate.h"
+#include "probability_tap.h"
+
 // Constants
 #define MAX_STRIDE 4  // Maximum expected stride value
 #define SAMPLES_PER_CHUNK 160  // 10ms @ 16kHz
+#define SAMPLES_PER_MS 16
 #define BYTES_PER_CHUNK (SAMPLES_PER_CHUNK * 2)  // 16-bit samples
 #define BYTES_PER_SAMPLE 2
 
-// TensorFlow Lite C API types
-typedef int TfLiteStatus;  // kTfLiteOk == 0
-typedef void *TfLiteModel;
-typedef void *TfLiteInterpreter;
-typedef void *TfLiteTensor;
-
+// Snapshot of one variable tensor's initial contents
 typedef struct {
-	float scale;
-	int32_t zero_point;
-} TfLiteQuantizationParams;
-
-// TensorFlow Lite C API function pointers
-typedef TfLiteModel (*TfLiteModelCreateFromFileFunc)(const char *);
-typedef TfLiteInterpreter (*TfLiteInterpreterCreateFunc)(TfLiteModel, void *);
-typedef TfLiteStatus (*TfLiteInterpreterAllocateTensorsFunc)(TfLiteInterpreter);
-typedef TfLiteStatus (*TfLiteInterpreterInvokeFunc)(TfLiteInterpreter);
-typedef TfLiteTensor (*TfLiteInterpreterGetInputTensorFunc)(TfLiteInterpreter, int32_t);
-typedef TfLiteTensor (*TfLiteInterpreterGetOutputTensorFunc)(TfLiteInterpreter, int32_t);
-typedef size_t (*TfLiteTensorByteSizeFunc)(TfLiteTensor);
-typedef int32_t (*TfLiteTensorNumDimsFunc)(TfLiteTensor);
-typedef int32_t (*TfLiteTensorDimFunc)(TfLiteTensor, int32_t);
-typedef TfLiteQuantizationParams (*TfLiteTensorQuantizationParamsFunc)(TfLiteTensor);
-typedef TfLiteStatus (*TfLiteTensorCopyFromBufferFunc)(TfLiteTensor, const void *, size_t);
-typedef TfLiteStatus (*TfLiteTensorCopyToBufferFunc)(TfLiteTensor, void *, size_t);
-typedef void (*TfLiteInterpreterDeleteFunc)(TfLiteInterpreter);
-typedef void (*TfLiteModelDeleteFunc)(TfLiteModel);
-
-// Feature buffer entry
-typedef struct {
-	float *features;
-	size_t features_size;
-} FeatureBufferEntry;
+	TfLiteTensor tensor;
+	uint8_t *initial;
+	size_t bytes;
+} StateSnapshotEntry;
 
-// Probability window (circular buffer)
+// Initial streaming state, restored on reset instead of reloading the model
 typedef struct {
-	float *probabilities;
-	size_t size;
+	StateSnapshotEntry *entries;
 	size_t count;
-	size_t head;
-} ProbabilityWindow;
+	bool valid;  // false if the model's state is not reachable through variable tensors
+} StateSnapshot;
+
+// Quantizes one frame into the input window; see stage_frame_body
+typedef int (*StageFunc)(MicroWakeWord *mww, const float *features);
 
 // MicroWakeWord structure
 struct MicroWakeWord {
-	void *tflite_handle;  // dlopen handle for tensorflowlite_c
-	TfLiteModel model;
+	TfLiteRuntime *rt;  // Shared TensorFlow Lite runtime
+	CachedModel *cached_model;  // Shared immutable model
+	TfLiteModel model;          // cached_model->model
 	TfLiteInterpreter interpreter;
+	TfLiteDelegate delegate;  // XNNPACK delegate of the interpreter, if any
+	bool xnnpack_active;
 	TfLiteTensor input_tensor;
 	TfLiteTensor output_tensor;
 
 	// Quantization parameters
 	float input_scale;
 	int32_t input_zero_point;
+	QuantizeParams input_quant;  // input_scale/zero_point with precomputed 1/scale
+	QuantizeFunc quantize;       // Kernel picked for this CPU and frame size
 	float output_scale;
 	int32_t output_zero_point;
 
 	// Detected stride from model
 	size_t stride;
 
-	// Feature buffer (dynamic, up to MAX_STRIDE entries)
-	FeatureBufferEntry feature_buffer[MAX_STRIDE];
-	size_t feature_buffer_count;
+	// Tensor memory. Frames are quantized straight into their stride slot of
+	// the input tensor and the output is read in place. If the runtime lacks
+	// TfLiteTensorData, these point at scratch buffers instead and are copied
+	// through TfLiteTensorCopyFromBuffer/CopyToBuffer.
+	uint8_t *input_data;
+	const uint8_t *output_data;
+	size_t frame_size;  // Features per frame (last input dimension)
+	size_t frame_count;  // Frames staged in input_data
+	StageFunc stage;     // Picked for stride and frame_size
+	bool copy_tensors;
+
+	// Copy fallback buffers, sized once from the tensor shapes and reused so
+	// the steady-state streaming path never touches the heap
+	size_t input_bytes;
+	uint8_t *quant_buffer;
+	size_t output_bytes;
+	uint8_t *output_buffer;
 
 	// Probability sliding window
 	ProbabilityWindow prob_window;
+	uint64_t outputs_read;  // Model outputs added to prob_window
+
+	// Stream position (in samples) at the end of the last frame
+	uint64_t sample_position;
+
+	// Detections are held back until sample_position reaches
+	// refractory_end_sample, outputs_read reaches refractory_end_output and
+	// the detector is armed again
+	uint64_t refractory_end_sample;
+	uint64_t refractory_end_output;
+	bool armed;
+
+	// Initial streaming state for fast reset
+	StateSnapshot state_snapshot;
+
+	// Performance counters (only updated while stats_enabled)
+	bool stats_enabled;
+	MicroWakeWordStats stats;
+
+	// Energy gate (NULL when disabled)
+	EnergyGate *gate;
+
+	// Raw probability tap (NULL when disabled)
+	ProbabilityTap *tap;
 
 	// Configuration
-	char *model_path;  // Stored for reset
+	ModelSource model_source;  // Stored for reload fallback (path is owned)
 	float probability_cutoff;
 	size_t sliding_window_size;
-
-	// Function pointers
-	TfLiteModelCreateFromFileFunc TfLiteModelCreateFromFile;
-	TfLiteInterpreterCreateFunc TfLiteInterpreterCreate;
-	TfLiteInterpreterAllocateTensorsFunc TfLiteInterpreterAllocateTensors;
-	TfLiteInterpreterInvokeFunc TfLiteInterpreterInvoke;
-	TfLiteInterpreterGetInputTensorFunc TfLiteInterpreterGetInputTensor;
-	TfLiteInterpreterGetOutputTensorFunc TfLiteInterpreterGetOutputTensor;
-	TfLiteTensorByteSizeFunc TfLiteTensorByteSize;
-	TfLiteTensorNumDimsFunc TfLiteTensorNumDims;
-	TfLiteTensorDimFunc TfLiteTensorDim;
-	TfLiteTensorQuantizationParamsFunc TfLiteTensorQuantizationParams;
-	TfLiteTensorCopyFromBufferFunc TfLiteTensorCopyFromBuffer;
-	TfLiteTensorCopyToBufferFunc TfLiteTensorCopyToBuffer;
-	TfLiteInterpreterDeleteFunc TfLiteInterpreterDelete;
-	TfLiteModelDeleteFunc TfLiteModelDelete;
+	int32_t num_threads;
+	bool use_xnnpack;
+	uint32_t model_id;
+	uint64_t refractory_samples;
+	uint64_t refractory_steps;
+	float rearm_cutoff;
 };
 
 // MicroWakeWordFeatures structure
 struct MicroWakeWordFeatures {
 	MicroFrontend *frontend;
-	uint8_t *audio_buffer;
-	size_t audio_buffer_size;
-	size_t audio_buffer_capacity;
-};
 
-// Helper function to find tensorflowlite_c library
-static const char *find_tflite_lib(const char *user_path) {
-	if (user_path && user_path[0] != '\0') {
-		return user_path;
-	}
+	// Audio backlog (ring buffer of bytes, head is always sample aligned)
+	int16_t ring[MICRO_WAKEWORD_FEATURES_BACKLOG_BYTES / BYTES_PER_SAMPLE];
+	size_t ring_head;
+	size_t ring_count;
 
-	// Try relative paths for development builds
-	static const char *dev_paths[] = {
-		"../lib/linux_amd64/libtensorflowlite_c.so",
-		"../lib/linux_arm64/libtensorflowlite_c.so",
-		"../lib/linux_armv7/libtensorflowlite_c.so",
-		"./libtensorflowlite_c.so",
-		NULL
-	};
+	// Contiguous copy of a chunk that wraps the ring or is misaligned
+	int16_t chunk[SAMPLES_PER_CHUNK];
 
-	for (size_t i = 0; dev_paths[i]; ++i) {
-		FILE *f = fopen(dev_paths[i], "r");
-		if (f) {
-			fclose(f);
-			return dev_paths[i];
-		}
-	}
+	uint64_t sample_position;  // Samples run through the frontend since create/reset
 
-	// Return system library name - dlopen will search standard paths
-	// (LD_LIBRARY_PATH, /usr/lib, /lib, etc.)
-	return "libtensorflowlite_c.so";
-}
+	// Performance counters (only updated while stats_enabled)
+	bool stats_enabled;
+	MicroWakeWordFeaturesStats stats;
+};
 
-// Load TensorFlow Lite C API functions
-static int load_tflite_functions(MicroWakeWord *mww, const char *lib_path) {
-	const char *lib = find_tflite_lib(lib_path);
-	if (!lib) {
-		return -1;
-	}
+// Receives each frame produced by features_generate
+// index: frame number within the call
+// end_sample: stream position (in samples) at the end of the frame
+// Returns 0 to continue, negative to stop with that error
+typedef int (*FrameSink)(void *ctx, const float *frame, size_t index, uint64_t end_sample);
 
-	mww->tflite_handle = dlopen(lib, RTLD_LAZY | RTLD_GLOBAL);
-	if (!mww->tflite_handle) {
-		return -2;
+// Delete the interpreter and the delegate it was built with
+static void destroy_interpreter(MicroWakeWord *mww) {
+	if (mww->interpreter) {
+		mww->rt->TfLiteInterpreterDelete(mww->interpreter);
+		mww->interpreter = NULL;
 	}
-
-	// Load function pointers
-	mww->TfLiteModelCreateFromFile = (TfLiteModelCreateFromFileFunc)
-		dlsym(mww->tflite_handle, "TfLiteModelCreateFromFile");
-	mww->TfLiteInterpreterCreate = (TfLiteInterpreterCreateFunc)
-		dlsym(mww->tflite_handle, "TfLiteInterpreterCreate");
-	mww->TfLiteInterpreterAllocateTensors = (TfLiteInterpreterAllocateTensorsFunc)
-		dlsym(mww->tflite_handle, "TfLiteInterpreterAllocateTensors");
-	mww->TfLiteInterpreterInvoke = (TfLiteInterpreterInvokeFunc)
-		dlsym(mww->tflite_handle, "TfLiteInterpreterInvoke");
-	mww->TfLiteInterpreterGetInputTensor = (TfLiteInterpreterGetInputTensorFunc)
-		dlsym(mww->tflite_handle, "TfLiteInterpreterGetInputTensor");
-	mww->TfLiteInterpreterGetOutputTensor = (TfLiteInterpreterGetOutputTensorFunc)
-		dlsym(mww->tflite_handle, "TfLiteInterpreterGetOutputTensor");
-	mww->TfLiteTensorByteSize = (TfLiteTensorByteSizeFunc)
-		dlsym(mww->tflite_handle, "TfLiteTensorByteSize");
-	mww->TfLiteTensorNumDims = (TfLiteTensorNumDimsFunc)
-		dlsym(mww->tflite_handle, "TfLiteTensorNumDims");
-	mww->TfLiteTensorDim = (TfLiteTensorDimFunc)
-		dlsym(mww->tflite_handle, "TfLiteTensorDim");
-	mww->TfLiteTensorQuantizationParams = (TfLiteTensorQuantizationParamsFunc)
-		dlsym(mww->tflite_handle, "TfLiteTensorQuantizationParams");
-	mww->TfLiteTensorCopyFromBuffer = (TfLiteTensorCopyFromBufferFunc)
-		dlsym(mww->tflite_handle, "TfLiteTensorCopyFromBuffer");
-	mww->TfLiteTensorCopyToBuffer = (TfLiteTensorCopyToBufferFunc)
-		dlsym(mww->tflite_handle, "TfLiteTensorCopyToBuffer");
-	mww->TfLiteInterpreterDelete = (TfLiteInterpreterDeleteFunc)
-		dlsym(mww->tflite_handle, "TfLiteInterpreterDelete");
-	mww->TfLiteModelDelete = (TfLiteModelDeleteFunc)
-		dlsym(mww->tflite_handle, "TfLiteModelDelete");
-
-	// Check if all functions loaded
-	if (!mww->TfLiteModelCreateFromFile || !mww->TfLiteInterpreterCreate ||
-	    !mww->TfLiteInterpreterAllocateTensors || !mww->TfLiteInterpreterInvoke ||
-	    !mww->TfLiteInterpreterGetInputTensor || !mww->TfLiteInterpreterGetOutputTensor ||
-	    !mww->TfLiteTensorByteSize || !mww->TfLiteTensorNumDims || !mww->TfLiteTensorDim ||
-	    !mww->TfLiteTensorQuantizationParams ||
-	    !mww->TfLiteTensorCopyFromBuffer || !mww->TfLiteTensorCopyToBuffer ||
-	    !mww->TfLiteInterpreterDelete || !mww->TfLiteModelDelete) {
-		dlclose(mww->tflite_handle);
-		return -3;
+	if (mww->delegate) {
+		mww->rt->TfLiteXNNPackDelegateDelete(mww->delegate);
+		mww->delegate = NULL;
 	}
-
-	return 0;
+	mww->xnnpack_active = false;
 }
 
-// Initialize probability window
-static int init_probability_window(ProbabilityWindow *window, size_t size) {
-	window->probabilities = (float *)malloc(size * sizeof(float));
-	if (!window->probabilities) {
-		return -1;
+// Create the XNNPACK delegate, or NULL if the runtime does not provide it
+static TfLiteDelegate create_xnnpack_delegate(MicroWakeWord *mww) {
+	TfLiteRuntime *rt = mww->rt;
+	if (!rt->TfLiteXNNPackDelegateOptionsDefault || !rt->TfLiteXNNPackDelegateCreate ||
+	    !rt->TfLiteXNNPackDelegateDelete || !rt->TfLiteInterpreterOptionsAddDelegate) {
+		return NULL;
 	}
-	window->size = size;
-	window->count = 0;
-	window->head = 0;
-	return 0;
-}
 
-// Add probability to window
-static void add_probability(ProbabilityWindow *window, float prob) {
-	window->probabilities[window->head] = prob;
-	window->head = (window->head + 1) % window->size;
-	if (window->count < window->size) {
-		window->count++;
+	TfLiteXNNPackDelegateOptions options = rt->TfLiteXNNPackDelegateOptionsDefault();
+	if (mww->num_threads > 0) {
+		options.num_threads = mww->num_threads;
 	}
+	return rt->TfLiteXNNPackDelegateCreate(&options);
 }
 
-// Calculate mean of probability window
-static float mean_probability(const ProbabilityWindow *window) {
-	if (window->count == 0) {
-		return 0.0f;
-	}
+// Create and allocate an interpreter, with the XNNPACK delegate if requested
+// Returns 0 on success, negative on error
+static int build_interpreter(MicroWakeWord *mww, bool with_xnnpack) {
+	TfLiteRuntime *rt = mww->rt;
+	TfLiteInterpreterOptions options = NULL;
 
-	float sum = 0.0f;
-	for (size_t i = 0; i < window->count; ++i) {
-		sum += window->probabilities[i];
+	// Without the options API the runtime defaults are all we can get
+	if ((mww->num_threads > 0 || with_xnnpack) &&
+	    rt->TfLiteInterpreterOptionsCreate && rt->TfLiteInterpreterOptionsDelete) {
+		options = rt->TfLiteInterpreterOptionsCreate();
 	}
-	return sum / window->count;
-}
-
-// Load model
-static int load_model(MicroWakeWord *mww, const char *model_path) {
-	mww->model = mww->TfLiteModelCreateFromFile(model_path);
-	if (!mww->model) {
+	if (options && mww->num_threads > 0 && rt->TfLiteInterpreterOptionsSetNumThreads) {
+		rt->TfLiteInterpreterOptionsSetNumThreads(options, mww->num_threads);
+	}
+	if (options && with_xnnpack) {
+		mww->delegate = create_xnnpack_delegate(mww);
+		if (mww->delegate) {
+			rt->TfLiteInterpreterOptionsAddDelegate(options, mww->delegate);
+		}
+	}
+	if (with_xnnpack && !mww->delegate) {
+		if (options) {
+			rt->TfLiteInterpreterOptionsDelete(options);
+		}
 		return -1;
 	}
 
-	mww->interpreter = mww->TfLiteInterpreterCreate(mww->model, NULL);
+	// The interpreter keeps its own copy of the options
+	mww->interpreter = rt->TfLiteInterpreterCreate(mww->model, options);
+	if (options) {
+		rt->TfLiteInterpreterOptionsDelete(options);
+	}
 	if (!mww->interpreter) {
-		mww->TfLiteModelDelete(mww->model);
-		mww->model = NULL;
+		destroy_interpreter(mww);
 		return -2;
 	}
 
-	if (mww->TfLiteInterpreterAllocateTensors(mww->interpreter) != 0) {
-		mww->TfLiteInterpreterDelete(mww->interpreter);
-		mww->TfLiteModelDelete(mww->model);
-		mww->interpreter = NULL;
-		mww->model = NULL;
+	if (rt->TfLiteInterpreterAllocateTensors(mww->interpreter) != 0) {
+		destroy_interpreter(mww);
 		return -3;
 	}
 
-	mww->input_tensor = mww->TfLiteInterpreterGetInputTensor(mww->interpreter, 0);
-	mww->output_tensor = mww->TfLiteInterpreterGetOutputTensor(mww->interpreter, 0);
+	mww->xnnpack_active = with_xnnpack;
+	return 0;
+}
+
+// Create interpreter for the already loaded model
+static int create_interpreter(MicroWakeWord *mww) {
+	// Fall back to the built-in kernels if the delegate is unavailable or
+	// rejects the model
+	int result = -1;
+	if (mww->use_xnnpack) {
+		result = build_interpreter(mww, true);
+	}
+	if (result != 0) {
+		result = build_interpreter(mww, false);
+	}
+	if (result != 0) {
+		return result;
+	}
+
+	mww->input_tensor = mww->rt->TfLiteInterpreterGetInputTensor(mww->interpreter, 0);
+	mww->output_tensor = mww->rt->TfLiteInterpreterGetOutputTensor(mww->interpreter, 0);
 
 	if (!mww->input_tensor || !mww->output_tensor) {
-		mww->TfLiteInterpreterDelete(mww->interpreter);
-		mww->TfLiteModelDelete(mww->model);
-		mww->interpreter = NULL;
-		mww->model = NULL;
+		destroy_interpreter(mww);
 		return -4;
 	}
 
 	// Get quantization parameters
-	TfLiteQuantizationParams input_q = mww->TfLiteTensorQuantizationParams(mww->input_tensor);
-	TfLiteQuantizationParams output_q = mww->TfLiteTensorQuantizationParams(mww->output_tensor);
+	TfLiteQuantizationParams input_q = mww->rt->TfLiteTensorQuantizationParams(mww->input_tensor);
+	TfLiteQuantizationParams output_q = mww->rt->TfLiteTensorQuantizationParams(mww->output_tensor);
 
 	mww->input_scale = input_q.scale;
 	mww->input_zero_point = input_q.zero_point;
+	quantize_params_init(&mww->input_quant, input_q.scale, input_q.zero_point);
 	mww->output_scale = output_q.scale;
 	mww->output_zero_point = output_q.zero_point;
 
 	// Detect stride from input tensor shape
 	// Expected shape: [1, stride, 40] where stride is dimension 1
-	int32_t num_dims = mww->TfLiteTensorNumDims(mww->input_tensor);
+	int32_t num_dims = mww->rt->TfLiteTensorNumDims(mww->input_tensor);
 	if (num_dims < 3) {
 		// Invalid shape, use default stride
 		mww->stride = 2;
 	} else {
 		// Get dimension 1 (stride dimension)
-		int32_t detected_stride = mww->TfLiteTensorDim(mww->input_tensor, 1);
+		int32_t detected_stride = mww->rt->TfLiteTensorDim(mww->input_tensor, 1);
 		if (detected_stride < 1 || detected_stride > MAX_STRIDE) {
 			// Invalid stride, use default
 			mww->stride = 2;
@@ -294,8 +274,257 @@ static int load_model(MicroWakeWord *mww, const char *model_path) {
 	return 0;
 }
 
-MicroWakeWord *micro_wakeword_create(const MicroWakeWordConfig *config) {
-	if (!config || !config->model_path) {
+// Release the shared model
+static void unload_model(MicroWakeWord *mww) {
+	model_cache_release(mww->cached_model);
+	mww->cached_model = NULL;
+	mww->model = NULL;
+}
+
+// Load model (shared with other detectors using the same source)
+static int load_model(MicroWakeWord *mww) {
+	mww->cached_model = model_cache_acquire(mww->rt, &mww->model_source);
+	if (!mww->cached_model) {
+		return -1;
+	}
+	mww->model = mww->cached_model->model;
+
+	int result = create_interpreter(mww);
+	if (result != 0) {
+		unload_model(mww);
+		return result;
+	}
+
+	return 0;
+}
+
+// Free state snapshot
+static void free_state_snapshot(StateSnapshot *snapshot) {
+	for (size_t i = 0; i < snapshot->count; ++i) {
+		free(snapshot->entries[i].initial);
+	}
+	free(snapshot->entries);
+	snapshot->entries = NULL;
+	snapshot->count = 0;
+	snapshot->valid = false;
+}
+
+// Snapshot the interpreter's variable tensors right after allocation.
+// Models that keep their streaming state in resource variables (such as the
+// bundled microWakeWord models) cannot be snapshotted through the C API, so
+// the snapshot is left invalid and reset falls back to a new interpreter.
+static void take_state_snapshot(MicroWakeWord *mww) {
+	StateSnapshot *snapshot = &mww->state_snapshot;
+	free_state_snapshot(snapshot);
+
+	if (!mww->rt->TfLiteInterpreterGetVariableTensorCount ||
+	    !mww->rt->TfLiteInterpreterGetVariableTensor ||
+	    !mww->rt->TfLiteInterpreterGetTensor ||
+	    !mww->rt->TfLiteTensorType || !mww->rt->TfLiteTensorData) {
+		return;
+	}
+
+	// Resource variables hold state outside of any tensor we can reach
+	for (int32_t i = 0;; ++i) {
+		TfLiteTensor tensor = mww->rt->TfLiteInterpreterGetTensor(mww->interpreter, i);
+		if (!tensor) {
+			break;
+		}
+		if (mww->rt->TfLiteTensorType(tensor) == TFLITE_TYPE_RESOURCE) {
+			return;
+		}
+	}
+
+	int32_t count = mww->rt->TfLiteInterpreterGetVariableTensorCount(mww->interpreter);
+	if (count > 0) {
+		snapshot->entries = (StateSnapshotEntry *)calloc((size_t)count,
+								 sizeof(StateSnapshotEntry));
+		if (!snapshot->entries) {
+			return;
+		}
+	}
+
+	for (int32_t i = 0; i < count; ++i) {
+		StateSnapshotEntry *entry = &snapshot->entries[snapshot->count];
+		entry->tensor = mww->rt->TfLiteInterpreterGetVariableTensor(mww->interpreter, i);
+		void *data = entry->tensor ? mww->rt->TfLiteTensorData(entry->tensor) : NULL;
+		if (!data) {
+			free_state_snapshot(snapshot);
+			return;
+		}
+
+		entry->bytes = mww->rt->TfLiteTensorByteSize(entry->tensor);
+		entry->initial = (uint8_t *)malloc(entry->bytes);
+		if (!entry->initial) {
+			free_state_snapshot(snapshot);
+			return;
+		}
+		memcpy(entry->initial, data, entry->bytes);
+		snapshot->count++;
+	}
+
+	snapshot->valid = true;
+}
+
+// Restore variable tensors from the snapshot
+static int restore_state_snapshot(MicroWakeWord *mww) {
+	const StateSnapshot *snapshot = &mww->state_snapshot;
+	if (!snapshot->valid) {
+		return -1;
+	}
+
+	for (size_t i = 0; i < snapshot->count; ++i) {
+		const StateSnapshotEntry *entry = &snapshot->entries[i];
+		void *data = mww->rt->TfLiteTensorData(entry->tensor);
+		if (!data) {
+			return -2;
+		}
+		memcpy(data, entry->initial, entry->bytes);
+	}
+
+	return 0;
+}
+
+// Quantize one frame into its stride slot of the input tensor, for a
+// window of stride frames of frame_size features. Inlined with constant
+// arguments into the specialized variants below.
+// Returns 1 if the interpreter is ready to invoke, 0 if more frames are
+// needed, negative on error
+static inline __attribute__((always_inline))
+int stage_frame_body(MicroWakeWord *mww, const float *features, size_t stride,
+		     size_t frame_size) {
+	// Quantize the frame into its slot of the input window. Frames are stored
+	// back to back, which is already the concatenated layout
+	// (matching Python: np.concatenate(self._features, axis=1))
+	uint64_t start_ns = mww->stats_enabled ? stats_clock_ns() : 0;
+	mww->quantize(features, mww->input_data + mww->frame_count * frame_size,
+		      frame_size, &mww->input_quant);
+	mww->frame_count++;
+	if (mww->stats_enabled) {
+		stats_stage_record(&mww->stats.quantize, start_ns);
+		mww->stats.frames++;
+	}
+
+	// Check if we have enough features (matching Python: if len(self._features) < stride)
+	if (mww->frame_count < stride) {
+		return 0;  // Not enough features yet
+	}
+
+	// Start the next window fresh (stride instead of rolling)
+	// Note: Python version clears buffer completely, next feature window starts fresh
+	mww->frame_count = 0;
+
+	// Copy to input tensor if its memory is not directly accessible
+	if (mww->copy_tensors &&
+	    mww->rt->TfLiteTensorCopyFromBuffer(mww->input_tensor, mww->quant_buffer,
+						stride * frame_size) != 0) {
+		return -3;
+	}
+
+	return 1;
+}
+
+// Any stride and frame size
+static int stage_frame_generic(MicroWakeWord *mww, const float *features) {
+	return stage_frame_body(mww, features, mww->stride, mww->frame_size);
+}
+
+// Fixed stride with MICRO_WAKEWORD_FEATURES_PER_FRAME features per frame
+#define DEFINE_STAGE_FRAME(STRIDE) \
+	static int stage_frame_##STRIDE(MicroWakeWord *mww, const float *features) { \
+		return stage_frame_body(mww, features, STRIDE, \
+					MICRO_WAKEWORD_FEATURES_PER_FRAME); \
+	}
+
+DEFINE_STAGE_FRAME(1)
+DEFINE_STAGE_FRAME(2)
+DEFINE_STAGE_FRAME(3)
+DEFINE_STAGE_FRAME(4)
+
+// Staging function for the model's input shape
+static StageFunc select_stage_func(size_t stride, size_t frame_size) {
+	static const StageFunc fixed[MAX_STRIDE + 1] = {
+		NULL, stage_frame_1, stage_frame_2, stage_frame_3, stage_frame_4
+	};
+
+	if (frame_size == MICRO_WAKEWORD_FEATURES_PER_FRAME && stride >= 1 && stride <= MAX_STRIDE) {
+		return fixed[stride];
+	}
+	return stage_frame_generic;
+}
+
+// Point input_data/output_data at the tensors of the current interpreter,
+// sizing the copy fallback buffers if the runtime cannot expose tensor
+// memory. Buffers only ever grow, so a reload of the same model does not
+// reallocate them.
+static int init_scratch_buffers(MicroWakeWord *mww) {
+	size_t input_bytes = mww->rt->TfLiteTensorByteSize(mww->input_tensor);
+	size_t output_bytes = mww->rt->TfLiteTensorByteSize(mww->output_tensor);
+	mww->input_data = NULL;
+	mww->output_data = NULL;
+	if (input_bytes == 0 || output_bytes == 0 || input_bytes % mww->stride != 0) {
+		return -1;
+	}
+
+	// Input tensor is uint8, so one byte per feature
+	mww->frame_size = input_bytes / mww->stride;
+	mww->frame_count = 0;
+
+	// Kernels specialized for the input shape
+	mww->quantize = quantize_select_frame(mww->frame_size);
+	mww->stage = select_stage_func(mww->stride, mww->frame_size);
+
+	if (mww->rt->TfLiteTensorData) {
+		mww->input_data = (uint8_t *)mww->rt->TfLiteTensorData(mww->input_tensor);
+		mww->output_data = (const uint8_t *)mww->rt->TfLiteTensorData(mww->output_tensor);
+		if (mww->input_data && mww->output_data) {
+			mww->copy_tensors = false;
+			return 0;
+		}
+	}
+
+	if (input_bytes > mww->input_bytes) {
+		uint8_t *quant_buffer = (uint8_t *)realloc(mww->quant_buffer, input_bytes);
+		if (!quant_buffer) {
+			return -2;
+		}
+		mww->quant_buffer = quant_buffer;
+		mww->input_bytes = input_bytes;
+	}
+
+	if (output_bytes > mww->output_bytes) {
+		uint8_t *output_buffer = (uint8_t *)realloc(mww->output_buffer, output_bytes);
+		if (!output_buffer) {
+			return -2;
+		}
+		mww->output_buffer = output_buffer;
+		mww->output_bytes = output_bytes;
+	}
+
+	mww->input_data = mww->quant_buffer;
+	mww->output_data = mww->output_buffer;
+	mww->copy_tensors = true;
+	return 0;
+}
+
+// Free scratch buffers
+static void free_scratch_buffers(MicroWakeWord *mww) {
+	free(mww->quant_buffer);
+	free(mww->output_buffer);
+	mww->input_data = NULL;
+	mww->output_data = NULL;
+	mww->quant_buffer = NULL;
+	mww->output_buffer = NULL;
+	mww->input_bytes = 0;
+	mww->output_bytes = 0;
+}
+
+// Create detector for the given model source
+static MicroWakeWord *create_detector(const MicroWakeWordConfig *config,
+				      const ModelSource *source) {
+	// Hysteresis needs the re-arm level below the cutoff
+	if (config->rearm_cutoff < 0.0f ||
+	    (config->rearm_cutoff > 0.0f && config->rearm_cutoff >= config->probability_cutoff)) {
 		return NULL;
 	}
 
@@ -304,167 +533,367 @@ MicroWakeWord *micro_wakeword_create(const MicroWakeWordConfig *config) {
 		return NULL;
 	}
 
-	// Load TensorFlow Lite library
-	int result = load_tflite_functions(mww, config->libtensorflowlite_c);
-	if (result != 0) {
+	// Take a reference to the shared TensorFlow Lite runtime
+	mww->rt = tflite_runtime_acquire(config->libtensorflowlite_c);
+	if (!mww->rt) {
 		free(mww);
 		return NULL;
 	}
 
 	// Initialize probability window
-	if (init_probability_window(&mww->prob_window, config->sliding_window_size) != 0) {
-		dlclose(mww->tflite_handle);
+	if (probability_window_init(&mww->prob_window, config->sliding_window_size) != 0) {
+		tflite_runtime_release(mww->rt);
 		free(mww);
 		return NULL;
 	}
 
 	mww->probability_cutoff = config->probability_cutoff;
 	mww->sliding_window_size = config->sliding_window_size;
-	mww->feature_buffer_count = 0;
+	mww->num_threads = config->num_threads > 0 ? config->num_threads : 0;
+	mww->use_xnnpack = config->use_xnnpack;
+	mww->model_id = config->model_id;
+	mww->refractory_samples = (uint64_t)config->refractory_ms * SAMPLES_PER_MS;
+	mww->refractory_steps = config->refractory_steps;
+	mww->rearm_cutoff = config->rearm_cutoff;
+	mww->armed = true;
+
+	// Store model source for reset
+	mww->model_source = *source;
+	if (source->path) {
+		mww->model_source.path = strdup(source->path);
+		if (!mww->model_source.path) {
+			probability_window_free(&mww->prob_window);
+			tflite_runtime_release(mww->rt);
+			free(mww);
+			return NULL;
+		}
+	}
 
-	// Store model path for reset
-	mww->model_path = strdup(config->model_path);
-	if (!mww->model_path) {
-		free(mww->prob_window.probabilities);
-		dlclose(mww->tflite_handle);
+	// Load model
+	if (load_model(mww) != 0) {
+		free((char *)mww->model_source.path);
+		probability_window_free(&mww->prob_window);
+		tflite_runtime_release(mww->rt);
 		free(mww);
 		return NULL;
 	}
 
-	// Load model
-	if (load_model(mww, config->model_path) != 0) {
-		free(mww->model_path);
-		free(mww->prob_window.probabilities);
-		dlclose(mww->tflite_handle);
+	// Allocate scratch space for the streaming path
+	if (init_scratch_buffers(mww) != 0) {
+		free_scratch_buffers(mww);
+		destroy_interpreter(mww);
+		unload_model(mww);
+		free((char *)mww->model_source.path);
+		probability_window_free(&mww->prob_window);
+		tflite_runtime_release(mww->rt);
 		free(mww);
 		return NULL;
 	}
 
+	// Remember initial streaming state for fast reset
+	take_state_snapshot(mww);
+
 	return mww;
 }
 
-bool micro_wakeword_process_streaming(MicroWakeWord *mww,
-				       const float *features,
-				       size_t features_size) {
-	if (!mww || !features || !mww->interpreter || !mww->model) {
-		return false;
+MicroWakeWord *micro_wakeword_create(const MicroWakeWordConfig *config) {
+	if (!config || !config->model_path) {
+		return NULL;
 	}
 
-	// Always add current features to buffer first (matching Python: self._features.append(features))
-	FeatureBufferEntry *entry = &mww->feature_buffer[mww->feature_buffer_count];
-	entry->features = (float *)malloc(features_size * sizeof(float));
-	if (!entry->features) {
-		return false;
+	ModelSource source = {
+		.kind = MODEL_SOURCE_FILE,
+		.path = config->model_path,
+	};
+	return create_detector(config, &source);
+}
+
+MicroWakeWord *micro_wakeword_create_from_buffer(const MicroWakeWordConfig *config,
+						 const void *model_data,
+						 size_t model_size) {
+	if (!config || !model_data || model_size == 0) {
+		return NULL;
 	}
-	memcpy(entry->features, features, features_size * sizeof(float));
-	entry->features_size = features_size;
-	mww->feature_buffer_count++;
 
-	// Check if we have enough features (matching Python: if len(self._features) < stride)
-	if (mww->feature_buffer_count < mww->stride) {
-		return false;  // Not enough features yet
+	ModelSource source = {
+		.kind = MODEL_SOURCE_BUFFER,
+		.data = model_data,
+		.size = model_size,
+	};
+	return create_detector(config, &source);
+}
+
+MicroWakeWord *micro_wakeword_create_from_mmap(const MicroWakeWordConfig *config,
+					       const char *path,
+					       size_t offset,
+					       size_t size) {
+	if (!config || !path) {
+		return NULL;
 	}
 
-	// Concatenate features (matching Python: np.concatenate(self._features, axis=1))
-	size_t total_features = 0;
-	for (size_t i = 0; i < mww->stride; ++i) {
-		total_features += mww->feature_buffer[i].features_size;
+	ModelSource source = {
+		.kind = MODEL_SOURCE_MMAP,
+		.path = path,
+		.offset = offset,
+		.size = size,
+	};
+	return create_detector(config, &source);
+}
+
+// Quantize one frame into its stride slot of the input tensor.
+// Returns 1 if the interpreter is ready to invoke, 0 if more frames are
+// needed, negative on error
+static int stage_frame(MicroWakeWord *mww, const float *features, size_t features_size) {
+	if (!mww || !features || !mww->interpreter || !mww->model || !mww->input_data) {
+		return -1;
 	}
 
-	// Allocate and concatenate
-	float *concatenated = (float *)malloc(total_features * sizeof(float));
-	if (!concatenated) {
-		return false;
+	// Each call carries exactly one frame of the model's input
+	if (features_size != mww->frame_size) {
+		return -2;
 	}
 
-	size_t offset = 0;
-	for (size_t i = 0; i < mww->stride; ++i) {
-		memcpy(concatenated + offset, mww->feature_buffer[i].features,
-		       mww->feature_buffer[i].features_size * sizeof(float));
-		offset += mww->feature_buffer[i].features_size;
+	return mww->stage(mww, features);
+}
+
+// Read the output of the last invocation, for the window ending at
+// end_sample, into the probability window
+// Returns 0 on success, non-zero on error
+static int read_output(MicroWakeWord *mww, uint64_t end_sample) {
+	// Read output (in place unless the tensor memory is not accessible)
+	if (mww->copy_tensors &&
+	    mww->rt->TfLiteTensorCopyToBuffer(mww->output_tensor, mww->output_buffer,
+					      mww->output_bytes) != 0) {
+		return -1;
 	}
 
-	// Quantize input
-	uint8_t *quant_features = (uint8_t *)malloc(total_features * sizeof(uint8_t));
-	if (!quant_features) {
-		free(concatenated);
-		return false;
+	// Dequantize output
+	// Python does: (output_data.astype(np.float32) - zero_point) * scale
+	// where output_data is a numpy array. For a single-element output, this becomes:
+	// (float32(output_data[0]) - zero_point) * scale
+	float result = ((float)mww->output_data[0] - mww->output_zero_point) * mww->output_scale;
+
+	// Add to probability window
+	probability_window_add(&mww->prob_window, result);
+	mww->outputs_read++;
+	if (mww->tap) {
+		probability_tap_push(mww->tap, end_sample, result);
 	}
+	return 0;
+}
 
-	for (size_t i = 0; i < total_features; ++i) {
-		// Match Python: np.round(...).astype(np.uint8)
-		// uint8 casting wraps negative values (e.g., -128 becomes 128)
-		float quant = roundf(concatenated[i] / mww->input_scale + mww->input_zero_point);
-		// Cast directly to uint8_t - this will wrap negative values correctly
-		// e.g., -128 wraps to 128, -1 wraps to 255
-		quant_features[i] = (uint8_t)(int32_t)quant;
+// Read the output of the last invocation and check for a detection
+// Returns 1 if the wake word is detected, 0 if not, negative on error
+static int finish_inference(MicroWakeWord *mww) {
+	if (read_output(mww, mww->sample_position) != 0) {
+		return -5;
 	}
 
-	// Copy to input tensor
-	if (mww->TfLiteTensorCopyFromBuffer(mww->input_tensor, quant_features,
-					     total_features * sizeof(uint8_t)) != 0) {
-		free(quant_features);
-		free(concatenated);
-		return false;
+	// Check if enough probabilities
+	if (mww->prob_window.count < mww->sliding_window_size) {
+		return 0;
 	}
 
-	// Run inference
-	if (mww->TfLiteInterpreterInvoke(mww->interpreter) != 0) {
-		free(quant_features);
-		free(concatenated);
-		return false;
+	// Check if mean probability exceeds cutoff
+	float mean_prob = probability_window_mean(&mww->prob_window);
+	if (!mww->armed && mean_prob <= mww->rearm_cutoff) {
+		mww->armed = true;
+	}
+	if (mean_prob <= mww->probability_cutoff) {
+		return 0;
 	}
 
-	// Read output
-	size_t output_bytes = mww->TfLiteTensorByteSize(mww->output_tensor);
-	uint8_t *output_data = (uint8_t *)malloc(output_bytes);
-	if (!output_data) {
-		free(quant_features);
-		free(concatenated);
-		return false;
+	// Hold back detections during the refractory period and until re-armed
+	if (!mww->armed || mww->sample_position < mww->refractory_end_sample ||
+	    mww->outputs_read < mww->refractory_end_output) {
+		if (mww->stats_enabled) {
+			mww->stats.suppressed++;
+		}
+		return 0;
 	}
 
-	if (mww->TfLiteTensorCopyToBuffer(mww->output_tensor, output_data, output_bytes) != 0) {
-		free(output_data);
-		free(quant_features);
-		free(concatenated);
-		return false;
+	mww->refractory_end_sample = mww->sample_position + mww->refractory_samples;
+	mww->refractory_end_output = mww->outputs_read + mww->refractory_steps;
+	mww->armed = !(mww->rearm_cutoff > 0.0f);
+	if (mww->stats_enabled) {
+		mww->stats.detections++;
 	}
+	return 1;
+}
 
-	// Debug: check output tensor size
-	// Note: For quantized models, output should be uint8, but tensor might be larger
-	// Python reads the entire output_bytes and converts to float32 array
+// Run the interpreter on the staged window
+// Returns 0 on success, non-zero on error
+static int invoke_interpreter(MicroWakeWord *mww) {
+	if (!mww->stats_enabled) {
+		return mww->rt->TfLiteInterpreterInvoke(mww->interpreter);
+	}
 
-	// Dequantize output
-	// Python does: (output_data.astype(np.float32) - zero_point) * scale
-	// where output_data is a numpy array. For a single-element output, this becomes:
-	// (float32(output_data[0]) - zero_point) * scale
-	float result = ((float)output_data[0] - mww->output_zero_point) * mww->output_scale;
+	uint64_t start_ns = stats_clock_ns();
+	int status = mww->rt->TfLiteInterpreterInvoke(mww->interpreter);
+	stats_stage_record(&mww->stats.invoke, start_ns);
+	if (status == 0) {
+		mww->stats.inferences++;
+	}
+	return status;
+}
 
-	// Add to probability window
-	add_probability(&mww->prob_window, result);
+// Put a full window of quantized features into the input tensor
+// Returns 0 on success, non-zero on error
+static int load_window(MicroWakeWord *mww, const uint8_t *window) {
+	size_t window_bytes = mww->stride * mww->frame_size;
+	memcpy(mww->input_data, window, window_bytes);
+	if (mww->copy_tensors &&
+	    mww->rt->TfLiteTensorCopyFromBuffer(mww->input_tensor, mww->quant_buffer,
+						window_bytes) != 0) {
+		return -1;
+	}
+	return 0;
+}
 
-	// Clear feature buffer (stride instead of rolling)
-	// Note: Python version clears buffer completely, next feature window starts fresh
-	for (size_t i = 0; i < mww->stride; ++i) {
-		free(mww->feature_buffer[i].features);
-		mww->feature_buffer[i].features = NULL;
-		mww->feature_buffer[i].features_size = 0;
+// Pass a staged window through the energy gate. Windows skipped while it is
+// closed are kept and run through the model once it opens, before the
+// staged window, so the model's streaming state is the same as if nothing
+// had been skipped (exactly, unless more than gate->capacity windows were
+// skipped in a row and the model looks further back than that).
+// The staged window ends at end_sample; the skipped ones came right before.
+// Returns 1 to invoke on the staged window, 0 if skipped, negative on error
+static int gate_window(MicroWakeWord *mww, uint64_t end_sample) {
+	EnergyGate *gate = mww->gate;
+	if (!energy_gate_end_window(gate)) {
+		energy_gate_push(gate, mww->input_data);
+		gate->skipped++;
+		return 0;
+	}
+	if (gate->count == 0) {
+		return 1;
 	}
-	mww->feature_buffer_count = 0;
 
-	free(output_data);
-	free(quant_features);
-	free(concatenated);
+	// Replayed outputs fill the probability window but are not reported
+	memcpy(gate->resume, mww->input_data, gate->window_bytes);
+	uint64_t window_samples = (uint64_t)mww->stride * SAMPLES_PER_CHUNK;
+	for (size_t i = 0; i < gate->count; ++i) {
+		uint64_t back = (gate->count - i) * window_samples;
+		if (load_window(mww, energy_gate_window(gate, i)) != 0 ||
+		    invoke_interpreter(mww) != 0 ||
+		    read_output(mww, end_sample > back ? end_sample - back : 0) != 0) {
+			energy_gate_clear(gate);
+			return -4;
+		}
+		gate->replayed++;
+	}
+	energy_gate_clear(gate);
 
-	// Check if enough probabilities
-	if (mww->prob_window.count < mww->sliding_window_size) {
+	return load_window(mww, gate->resume) == 0 ? 1 : -3;
+}
+
+// Stage one frame, ending at end_sample, and pass each completed window
+// through the energy gate
+// Returns 1 if the interpreter is ready to invoke, 0 if not, negative on error
+static int prepare_window(MicroWakeWord *mww, const float *features, size_t features_size,
+			  uint64_t end_sample) {
+	int staged = stage_frame(mww, features, features_size);
+	if (staged < 0 || !mww->gate) {
+		return staged;
+	}
+
+	energy_gate_add_frame(mww->gate, features, features_size);
+	if (staged == 0) {
+		return 0;
+	}
+	return gate_window(mww, end_sample);
+}
+
+// Run one frame, ending at stream position end_sample, through the detector
+// Returns 1 if the wake word is detected, 0 if not, negative on error
+static int process_frame(MicroWakeWord *mww, const float *features, size_t features_size,
+			 uint64_t end_sample) {
+	int staged = prepare_window(mww, features, features_size, end_sample);
+	if (staged < 0) {
+		return staged;
+	}
+	mww->sample_position = end_sample;
+	if (staged == 0) {
+		return 0;
+	}
+
+	// Run inference
+	if (invoke_interpreter(mww) != 0) {
+		return -4;
+	}
+
+	return finish_inference(mww);
+}
+
+// Describe the detection the last frame triggered
+static void fill_detection(const MicroWakeWord *mww, MicroWakeWordDetection *detection) {
+	detection->sample_offset = mww->sample_position;
+	detection->probability = probability_window_mean(&mww->prob_window);
+	detection->peak_probability = probability_window_max(&mww->prob_window);
+	detection->model_id = mww->model_id;
+}
+
+bool micro_wakeword_process_streaming(MicroWakeWord *mww,
+				       const float *features,
+				       size_t features_size) {
+	if (!mww) {
 		return false;
 	}
+	return process_frame(mww, features, features_size,
+			     mww->sample_position + SAMPLES_PER_CHUNK) == 1;
+}
 
-	// Check if mean probability exceeds cutoff
-	float mean_prob = mean_probability(&mww->prob_window);
-	return mean_prob > mww->probability_cutoff;
+int micro_wakeword_process_frame(MicroWakeWord *mww,
+				 const float *features,
+				 size_t features_size,
+				 MicroWakeWordResult *result) {
+	if (!mww) {
+		return -1;
+	}
+	return micro_wakeword_process_frame_at(mww, features, features_size,
+					       mww->sample_position + SAMPLES_PER_CHUNK, result);
+}
+
+int micro_wakeword_process_frame_at(MicroWakeWord *mww,
+				    const float *features,
+				    size_t features_size,
+				    uint64_t end_sample,
+				    MicroWakeWordResult *result) {
+	if (!mww) {
+		return -1;
+	}
+
+	uint64_t outputs_read = mww->outputs_read;
+	int status = process_frame(mww, features, features_size, end_sample);
+	if (status < 0 || !result) {
+		return status;
+	}
+
+	result->sample_offset = mww->sample_position;
+	result->probability = probability_window_latest(&mww->prob_window);
+	result->mean_probability = probability_window_mean(&mww->prob_window);
+	result->peak_probability = probability_window_max(&mww->prob_window);
+	result->model_id = mww->model_id;
+	result->inferences = (uint32_t)(mww->outputs_read - outputs_read);
+	result->detected = (status == 1);
+	return status;
+}
+
+uint64_t micro_wakeword_get_sample_position(MicroWakeWord *mww) {
+	return mww ? mww->sample_position : 0;
+}
+
+// Point the detector at a freshly created interpreter and snapshot its
+// initial state. If the tensors cannot be reached, the interpreter is
+// dropped again so stage_frame rejects frames instead of writing through
+// NULL buffers.
+static void finish_rebuild(MicroWakeWord *mww) {
+	if (init_scratch_buffers(mww) != 0) {
+		destroy_interpreter(mww);
+		mww->input_data = NULL;
+		mww->output_data = NULL;
+		return;
+	}
+	take_state_snapshot(mww);
 }
 
 void micro_wakeword_reset(MicroWakeWord *mww) {
@@ -472,31 +901,48 @@ void micro_wakeword_reset(MicroWakeWord *mww) {
 		return;
 	}
 
-	// Clear feature buffer (use MAX_STRIDE to ensure all entries are cleared)
-	for (size_t i = 0; i < MAX_STRIDE; ++i) {
-		free(mww->feature_buffer[i].features);
-		mww->feature_buffer[i].features = NULL;
-		mww->feature_buffer[i].features_size = 0;
+	if (mww->stats_enabled) {
+		mww->stats.resets++;
 	}
-	mww->feature_buffer_count = 0;
+
+	// Discard partially staged window
+	mww->frame_count = 0;
+	mww->sample_position = 0;
+
+	// Forget the last detection
+	mww->refractory_end_sample = 0;
+	mww->refractory_end_output = 0;
+	mww->armed = true;
 
 	// Clear probability window
-	mww->prob_window.count = 0;
-	mww->prob_window.head = 0;
+	probability_window_clear(&mww->prob_window);
 
-	// Reload model to reset internal state (this will also re-detect stride)
-	if (mww->interpreter) {
-		mww->TfLiteInterpreterDelete(mww->interpreter);
-		mww->interpreter = NULL;
+	// Skipped windows belong to the discarded state
+	if (mww->gate) {
+		energy_gate_reset(mww->gate);
 	}
-	if (mww->model) {
-		mww->TfLiteModelDelete(mww->model);
-		mww->model = NULL;
+
+	// Restore the initial streaming state in place if possible
+	if (restore_state_snapshot(mww) == 0) {
+		return;
 	}
 
-	// Reload model
-	if (mww->model_path) {
-		load_model(mww, mww->model_path);
+	// Otherwise rebuild the interpreter from the already parsed model. The
+	// snapshot and tensor pointers refer to the old interpreter, so drop them;
+	// until a rebuild succeeds stage_frame rejects every frame.
+	free_state_snapshot(&mww->state_snapshot);
+	destroy_interpreter(mww);
+	mww->input_data = NULL;
+	mww->output_data = NULL;
+	if (mww->model && create_interpreter(mww) == 0) {
+		finish_rebuild(mww);
+		return;
+	}
+
+	// Last resort: reload model from disk (this will also re-detect stride)
+	unload_model(mww);
+	if (load_model(mww) == 0) {
+		finish_rebuild(mww);
 	}
 }
 
@@ -514,11 +960,15 @@ void micro_wakeword_get_quantization_params(MicroWakeWord *mww,
 	if (output_zero_point) *output_zero_point = mww->output_zero_point;
 }
 
+bool micro_wakeword_uses_xnnpack(MicroWakeWord *mww) {
+	return mww && mww->xnnpack_active;
+}
+
 size_t micro_wakeword_get_buffer_size(MicroWakeWord *mww) {
 	if (!mww) {
 		return 0;
 	}
-	return mww->feature_buffer_count;
+	return mww->frame_count;
 }
 
 size_t micro_wakeword_get_probabilities(MicroWakeWord *mww,
@@ -530,22 +980,118 @@ size_t micro_wakeword_get_probabilities(MicroWakeWord *mww,
 		return 0;
 	}
 
-	if (mww->prob_window.count > 0) {
-		// Get latest probability (most recently added)
-		size_t latest_idx = (mww->prob_window.head == 0) ?
-			mww->prob_window.size - 1 : mww->prob_window.head - 1;
-		if (latest_prob) {
-			*latest_prob = mww->prob_window.probabilities[latest_idx];
+	if (latest_prob) *latest_prob = probability_window_latest(&mww->prob_window);
+	if (mean_prob) *mean_prob = probability_window_mean(&mww->prob_window);
+
+	return mww->prob_window.count;
+}
+
+void micro_wakeword_enable_stats(MicroWakeWord *mww, bool enable) {
+	if (!mww) {
+		return;
+	}
+	if (enable && !mww->stats_enabled) {
+		memset(&mww->stats, 0, sizeof(mww->stats));
+	}
+	mww->stats_enabled = enable;
+}
+
+int micro_wakeword_get_stats(MicroWakeWord *mww, MicroWakeWordStats *stats) {
+	if (!mww || !stats) {
+		return -1;
+	}
+	*stats = mww->stats;
+	stats->buffered_frames = mww->frame_count;
+	return 0;
+}
+
+int micro_wakeword_set_energy_gate(MicroWakeWord *mww, const MicroWakeWordEnergyGate *config) {
+	if (!mww) {
+		return -1;
+	}
+
+	EnergyGate *gate = NULL;
+	if (config) {
+		gate = (EnergyGate *)malloc(sizeof(EnergyGate));
+		if (!gate) {
+			return -2;
 		}
-		if (mean_prob) {
-			*mean_prob = mean_probability(&mww->prob_window);
+		// Replaying fewer windows than the probability window holds would
+		// leave it short after the gate opens
+		if (energy_gate_init(gate, config, mww->stride * mww->frame_size,
+				     mww->sliding_window_size) != 0) {
+			energy_gate_free(gate);
+			free(gate);
+			return -3;
 		}
-	} else {
-		if (latest_prob) *latest_prob = 0.0f;
-		if (mean_prob) *mean_prob = 0.0f;
 	}
 
-	return mww->prob_window.count;
+	if (mww->gate) {
+		energy_gate_free(mww->gate);
+		free(mww->gate);
+	}
+	mww->gate = gate;
+	return 0;
+}
+
+int micro_wakeword_get_energy_gate_stats(MicroWakeWord *mww,
+					 MicroWakeWordEnergyGateStats *stats) {
+	if (!mww || !mww->gate || !stats) {
+		return -1;
+	}
+
+	const EnergyGate *gate = mww->gate;
+	stats->windows = gate->total_windows;
+	stats->skipped = gate->skipped;
+	stats->replayed = gate->replayed;
+	stats->pending = gate->count;
+	stats->noise_floor = gate->noise_floor;
+	stats->open = gate->hangover_left > 0;
+	return 0;
+}
+
+int micro_wakeword_set_probability_tap(MicroWakeWord *mww, size_t capacity) {
+	if (!mww) {
+		return -1;
+	}
+
+	ProbabilityTap *tap = NULL;
+	if (capacity > 0) {
+		tap = (ProbabilityTap *)malloc(sizeof(ProbabilityTap));
+		if (!tap) {
+			return -2;
+		}
+		if (probability_tap_init(tap, capacity) != 0) {
+			probability_tap_free(tap);
+			free(tap);
+			return -3;
+		}
+	}
+
+	if (mww->tap) {
+		probability_tap_free(mww->tap);
+		free(mww->tap);
+	}
+	mww->tap = tap;
+	return 0;
+}
+
+size_t micro_wakeword_read_probabilities(MicroWakeWord *mww,
+					 MicroWakeWordProbability *entries,
+					 size_t max_entries) {
+	if (!mww || !mww->tap || !entries) {
+		return 0;
+	}
+	return probability_tap_read(mww->tap, entries, max_entries);
+}
+
+int micro_wakeword_get_probability_tap_stats(MicroWakeWord *mww,
+					     MicroWakeWordProbabilityTapStats *stats) {
+	if (!mww || !mww->tap || !stats) {
+		return -1;
+	}
+	probability_tap_get_stats(mww->tap, stats);
+	return 0;
 }
 
 void micro_wakeword_destroy(MicroWakeWord *mww) {
@@ -553,29 +1099,36 @@ void micro_wakeword_destroy(MicroWakeWord *mww) {
 		return;
 	}
 
-	// Clear feature buffer
-	for (size_t i = 0; i < MAX_STRIDE; ++i) {
-		free(mww->feature_buffer[i].features);
+	// Free energy gate
+	if (mww->gate) {
+		energy_gate_free(mww->gate);
+		free(mww->gate);
+	}
+
+	// Free probability tap
+	if (mww->tap) {
+		probability_tap_free(mww->tap);
+		free(mww->tap);
 	}
 
+	// Free scratch buffers
+	free_scratch_buffers(mww);
+
 	// Free probability window
-	free(mww->prob_window.probabilities);
+	probability_window_free(&mww->prob_window);
+
+	// Free state snapshot
+	free_state_snapshot(&mww->state_snapshot);
 
 	// Delete interpreter and model
-	if (mww->interpreter) {
-		mww->TfLiteInterpreterDelete(mww->interpreter);
-	}
-	if (mww->model) {
-		mww->TfLiteModelDelete(mww->model);
-	}
+	destroy_interpreter(mww);
+	unload_model(mww);
 
 	// Free model path
-	free(mww->model_path);
+	free((char *)mww->model_source.path);
 
-	// Close library
-	if (mww->tflite_handle) {
-		dlclose(mww->tflite_handle);
-	}
+	// Release shared runtime
+	tflite_runtime_release(mww->rt);
 
 	free(mww);
 }
@@ -592,16 +1145,168 @@ MicroWakeWordFeatures *micro_wakeword_features_create(void) {
 		return NULL;
 	}
 
-	features->audio_buffer_size = 0;
-	features->audio_buffer_capacity = 4096;  // Initial capacity
-	features->audio_buffer = (uint8_t *)malloc(features->audio_buffer_capacity);
-	if (!features->audio_buffer) {
-		micro_frontend_destroy(features->frontend);
-		free(features);
-		return NULL;
+	return features;
+}
+
+// Copy bytes out of the ring starting at offset bytes past the head
+static void ring_read(const MicroWakeWordFeatures *features, size_t offset,
+		      uint8_t *dst, size_t size) {
+	const uint8_t *ring = (const uint8_t *)features->ring;
+	size_t pos = (features->ring_head + offset) % MICRO_WAKEWORD_FEATURES_BACKLOG_BYTES;
+	size_t first = MICRO_WAKEWORD_FEATURES_BACKLOG_BYTES - pos;
+	if (first > size) {
+		first = size;
 	}
+	memcpy(dst, ring + pos, first);
+	memcpy(dst + first, ring, size - first);
+}
 
-	return features;
+// Append bytes at the tail of the ring (caller checks capacity)
+static void ring_write(MicroWakeWordFeatures *features, const uint8_t *src, size_t size) {
+	uint8_t *ring = (uint8_t *)features->ring;
+	size_t pos = (features->ring_head + features->ring_count) %
+		     MICRO_WAKEWORD_FEATURES_BACKLOG_BYTES;
+	size_t first = MICRO_WAKEWORD_FEATURES_BACKLOG_BYTES - pos;
+	if (first > size) {
+		first = size;
+	}
+	memcpy(ring + pos, src, first);
+	memcpy(ring, src + first, size - first);
+	features->ring_count += size;
+}
+
+// Drop bytes from the head of the ring
+static void ring_consume(MicroWakeWordFeatures *features, size_t size) {
+	features->ring_head = (features->ring_head + size) % MICRO_WAKEWORD_FEATURES_BACKLOG_BYTES;
+	features->ring_count -= size;
+	if (features->ring_count == 0) {
+		features->ring_head = 0;
+	}
+}
+
+// Run the backlog followed by new audio through the frontend, handing at most
+// max_frames frames to sink. Whole chunks of the new audio are read in place;
+// only a partial chunk, or audio left over once max_frames is reached, is
+// copied into the backlog.
+// Returns the number of frames produced, or negative on error
+static int features_generate(MicroWakeWordFeatures *features,
+			     const uint8_t *audio_bytes,
+			     size_t audio_size,
+			     size_t max_frames,
+			     FrameSink sink,
+			     void *ctx) {
+	// Whatever is left once max_frames frames are out must fit in the backlog
+	size_t total = features->ring_count + audio_size;
+	if (max_frames < total / BYTES_PER_CHUNK &&
+	    total - max_frames * BYTES_PER_CHUNK > MICRO_WAKEWORD_FEATURES_BACKLOG_BYTES) {
+		return -2;
+	}
+
+	size_t frames = 0;
+	int status = 0;
+	if (features->stats_enabled) {
+		features->stats.audio_bytes += audio_size;
+	}
+
+	while (frames < max_frames) {
+		const int16_t *chunk_samples;
+		bool from_ring;
+
+		if (features->ring_count > 0 && features->ring_count < BYTES_PER_CHUNK &&
+		    audio_size > 0) {
+			// Top up a partial chunk from the new audio
+			size_t size = BYTES_PER_CHUNK - features->ring_count;
+			if (size > audio_size) {
+				size = audio_size;
+			}
+			ring_write(features, audio_bytes, size);
+			audio_bytes += size;
+			audio_size -= size;
+			continue;
+		}
+
+		if (features->ring_count >= BYTES_PER_CHUNK) {
+			if (features->ring_head + BYTES_PER_CHUNK <= MICRO_WAKEWORD_FEATURES_BACKLOG_BYTES) {
+				chunk_samples = features->ring + features->ring_head / BYTES_PER_SAMPLE;
+			} else {
+				ring_read(features, 0, (uint8_t *)features->chunk, BYTES_PER_CHUNK);
+				chunk_samples = features->chunk;
+			}
+			from_ring = true;
+		} else if (features->ring_count == 0 && audio_size >= BYTES_PER_CHUNK) {
+			if ((uintptr_t)audio_bytes % sizeof(int16_t) == 0) {
+				chunk_samples = (const int16_t *)audio_bytes;
+			} else {
+				memcpy(features->chunk, audio_bytes, BYTES_PER_CHUNK);
+				chunk_samples = features->chunk;
+			}
+			from_ring = false;
+		} else {
+			break;  // Less than a chunk available
+		}
+
+		MicroFrontendOutput output;
+		// micro_frontend_process_samples expects number of samples, not bytes
+		uint64_t start_ns = features->stats_enabled ? stats_clock_ns() : 0;
+		int result = micro_frontend_process_samples(features->frontend,
+							    (int16_t *)chunk_samples,
+							    SAMPLES_PER_CHUNK, &output);
+		if (features->stats_enabled) {
+			stats_stage_record(&features->stats.frontend, start_ns);
+		}
+
+		size_t consumed = output.samples_read * BYTES_PER_SAMPLE;
+		if (from_ring) {
+			ring_consume(features, consumed);
+		} else {
+			audio_bytes += consumed;
+			audio_size -= consumed;
+		}
+		features->sample_position += output.samples_read;
+
+		if (result == 0 && output.features_size > 0) {
+			if (output.features_size != MICRO_WAKEWORD_FEATURES_PER_FRAME) {
+				status = -4;
+			} else {
+				status = sink(ctx, output.features, frames, features->sample_position);
+				frames++;
+			}
+		}
+
+		if (output.features) {
+			free(output.features);
+		}
+
+		if (status < 0) {
+			break;
+		}
+	}
+
+	// Keep the rest for the next call
+	if (audio_size > 0) {
+		if (features->ring_count + audio_size > MICRO_WAKEWORD_FEATURES_BACKLOG_BYTES) {
+			return status < 0 ? status : -2;
+		}
+		ring_write(features, audio_bytes, audio_size);
+	}
+
+	if (features->stats_enabled) {
+		features->stats.frames += frames;
+		if (features->ring_count > features->stats.max_buffered_bytes) {
+			features->stats.max_buffered_bytes = features->ring_count;
+		}
+	}
+
+	return status < 0 ? status : (int)frames;
+}
+
+// Copy each frame into a flat array of frames
+static int copy_frame(void *ctx, const float *frame, size_t index, uint64_t end_sample) {
+	(void)end_sample;
+	float *features_out = (float *)ctx;
+	memcpy(features_out + index * MICRO_WAKEWORD_FEATURES_PER_FRAME, frame,
+	       MICRO_WAKEWORD_FEATURES_PER_FRAME * sizeof(float));
+	return 0;
 }
 
 int micro_wakeword_features_process_streaming(
@@ -617,82 +1322,252 @@ int micro_wakeword_features_process_streaming(
 	*features_out = NULL;
 	*features_size_out = 0;
 
-	// Append to buffer (audio_bytes is already in the correct format - raw bytes from WAV)
-	if (features->audio_buffer_size + audio_size > features->audio_buffer_capacity) {
-		size_t new_capacity = features->audio_buffer_capacity * 2;
-		while (new_capacity < features->audio_buffer_size + audio_size) {
-			new_capacity *= 2;
-		}
-		uint8_t *new_buffer = (uint8_t *)realloc(features->audio_buffer, new_capacity);
-		if (!new_buffer) {
-			return -2;
-		}
-		features->audio_buffer = new_buffer;
-		features->audio_buffer_capacity = new_capacity;
+	// At most one frame per chunk (audio_bytes is already in the correct format - raw bytes from WAV)
+	size_t max_frames = (features->ring_count + audio_size) / BYTES_PER_CHUNK;
+	if (max_frames == 0) {
+		// Not enough data
+		return features_generate(features, audio_bytes, audio_size, 0, copy_frame, NULL);
 	}
 
-	memcpy(features->audio_buffer + features->audio_buffer_size, audio_bytes, audio_size);
-	features->audio_buffer_size += audio_size;
+	float *all_features = (float *)malloc(max_frames * MICRO_WAKEWORD_FEATURES_PER_FRAME *
+					      sizeof(float));
+	if (!all_features) {
+		return -3;
+	}
 
-	// Process chunks
-	if (features->audio_buffer_size < BYTES_PER_CHUNK) {
-		return 0;  // Not enough data
+	int frames = features_generate(features, audio_bytes, audio_size, max_frames,
+				       copy_frame, all_features);
+	if (frames < 0) {
+		free(all_features);
+		return frames;
 	}
 
-	// Estimate max features (one per chunk, 40 features each)
-	size_t max_features = (features->audio_buffer_size / BYTES_PER_CHUNK) * 40;
-	float *all_features = (float *)malloc(max_features * sizeof(float));
-	if (!all_features) {
-		return -3;
+	*features_out = all_features;
+	*features_size_out = (size_t)frames * MICRO_WAKEWORD_FEATURES_PER_FRAME;
+	return 0;
+}
+
+int micro_wakeword_features_process_streaming_into(
+	MicroWakeWordFeatures *features,
+	const uint8_t *audio_bytes,
+	size_t audio_size,
+	float *features_out,
+	size_t max_frames) {
+	if (!features || (!audio_bytes && audio_size > 0) ||
+	    (!features_out && max_frames > 0)) {
+		return -1;
 	}
 
-	size_t total_features = 0;
-	size_t buffer_idx = 0;
+	return features_generate(features, audio_bytes, audio_size, max_frames,
+				 copy_frame, features_out);
+}
 
-	while (buffer_idx + BYTES_PER_CHUNK <= features->audio_buffer_size) {
-		MicroFrontendOutput output;
-		int16_t *chunk_samples = (int16_t *)(features->audio_buffer + buffer_idx);
-		// micro_frontend_process_samples expects number of samples, not bytes
-		int result = micro_frontend_process_samples(features->frontend, chunk_samples,
-							    SAMPLES_PER_CHUNK, &output);
+// Caller's frame callback, adapted to a FrameSink
+typedef struct {
+	MicroWakeWordFrameCallback callback;
+	void *user_data;
+} CallbackSink;
+
+static int callback_frame(void *ctx, const float *frame, size_t index, uint64_t end_sample) {
+	(void)index;
+	CallbackSink *sink = (CallbackSink *)ctx;
+	int result = sink->callback(sink->user_data, frame, end_sample);
+	return result < 0 ? result : 0;
+}
 
-		if (result == 0 && output.features_size > 0) {
-			// Resize if needed
-			if (total_features + output.features_size > max_features) {
-				max_features = (total_features + output.features_size) * 2;
-				float *new_features = (float *)realloc(all_features,
-									max_features * sizeof(float));
-				if (!new_features) {
-					free(output.features);
-					free(all_features);
-					return -4;
-				}
-				all_features = new_features;
+int micro_wakeword_features_process_streaming_callback(
+	MicroWakeWordFeatures *features,
+	const uint8_t *audio_bytes,
+	size_t audio_size,
+	MicroWakeWordFrameCallback callback,
+	void *user_data) {
+	if (!features || (!audio_bytes && audio_size > 0) || !callback) {
+		return -1;
+	}
+
+	CallbackSink sink = { callback, user_data };
+	return features_generate(features, audio_bytes, audio_size, SIZE_MAX,
+				 callback_frame, &sink);
+}
+
+// Detections collected by micro_wakeword_process_audio
+typedef struct {
+	MicroWakeWord *mww;
+	MicroWakeWordDetection *detections;
+	size_t max_detections;
+	size_t count;
+} DetectionSink;
+
+// Feed each frame straight into the detector
+static int detect_frame(void *ctx, const float *frame, size_t index, uint64_t end_sample) {
+	(void)index;
+	DetectionSink *sink = (DetectionSink *)ctx;
+
+	int result = process_frame(sink->mww, frame, MICRO_WAKEWORD_FEATURES_PER_FRAME, end_sample);
+	if (result <= 0) {
+		return result;
+	}
+
+	if (sink->count < sink->max_detections) {
+		fill_detection(sink->mww, &sink->detections[sink->count]);
+	}
+	sink->count++;
+	return 0;
+}
+
+int micro_wakeword_process_audio(MicroWakeWord *mww,
+				 MicroWakeWordFeatures *features,
+				 const uint8_t *audio_bytes,
+				 size_t audio_size,
+				 MicroWakeWordDetection *detections,
+				 size_t max_detections) {
+	if (!mww || !features || (!audio_bytes && audio_size > 0) ||
+	    (!detections && max_detections > 0)) {
+		return -1;
+	}
+
+	DetectionSink sink = { mww, detections, max_detections, 0 };
+	int result = features_generate(features, audio_bytes, audio_size, SIZE_MAX,
+				       detect_frame, &sink);
+	if (result < 0) {
+		return result;
+	}
+
+	return (int)sink.count;
+}
+
+// MicroWakeWordMulti structure
+struct MicroWakeWordMulti {
+	MicroWakeWordFeatures *features;  // Shared by all models
+	MicroWakeWord *detectors[MICRO_WAKEWORD_MULTI_MAX_MODELS];
+	size_t num_models;
+};
+
+// Result collected by micro_wakeword_multi_process_audio
+typedef struct {
+	MicroWakeWordMulti *multi;
+	MicroWakeWordMultiResult *result;
+	size_t total;
+	int status;  // First model error, if any
+} MultiSink;
+
+// Fan each frame out to every model
+static int detect_frame_multi(void *ctx, const float *frame, size_t index, uint64_t end_sample) {
+	(void)index;
+	MultiSink *sink = (MultiSink *)ctx;
+	MicroWakeWordMultiResult *result = sink->result;
+
+	for (size_t i = 0; i < sink->multi->num_models; ++i) {
+		MicroWakeWord *mww = sink->multi->detectors[i];
+		int detected = process_frame(mww, frame, MICRO_WAKEWORD_FEATURES_PER_FRAME, end_sample);
+		if (detected < 0) {
+			// Keep feeding the other models so they stay in step; the
+			// error is reported once all the audio has been processed
+			if (sink->status == 0) {
+				sink->status = detected;
 			}
+			continue;
+		}
+		if (detected == 0) {
+			continue;
+		}
 
-			memcpy(all_features + total_features, output.features,
-			       output.features_size * sizeof(float));
-			total_features += output.features_size;
+		if (result->detections[i] == 0) {
+			fill_detection(mww, &result->first[i]);
 		}
+		result->detections[i]++;
+		sink->total++;
+	}
+	return 0;
+}
 
-		if (output.features) {
-			free(output.features);
+MicroWakeWordMulti *micro_wakeword_multi_create(const MicroWakeWordConfig *configs,
+						size_t num_models) {
+	if (!configs || num_models == 0 || num_models > MICRO_WAKEWORD_MULTI_MAX_MODELS) {
+		return NULL;
+	}
+
+	MicroWakeWordMulti *multi = (MicroWakeWordMulti *)calloc(1, sizeof(MicroWakeWordMulti));
+	if (!multi) {
+		return NULL;
+	}
+
+	multi->features = micro_wakeword_features_create();
+	if (!multi->features) {
+		free(multi);
+		return NULL;
+	}
+
+	for (size_t i = 0; i < num_models; ++i) {
+		MicroWakeWord *mww = micro_wakeword_create(&configs[i]);
+		// Every model must consume the shared 40-bin frames
+		if (!mww || mww->frame_size != MICRO_WAKEWORD_FEATURES_PER_FRAME) {
+			micro_wakeword_destroy(mww);
+			micro_wakeword_multi_destroy(multi);
+			return NULL;
 		}
+		multi->detectors[multi->num_models++] = mww;
+	}
 
-		buffer_idx += output.samples_read * BYTES_PER_SAMPLE;
+	return multi;
+}
+
+int micro_wakeword_multi_process_audio(MicroWakeWordMulti *multi,
+				       const uint8_t *audio_bytes,
+				       size_t audio_size,
+				       MicroWakeWordMultiResult *result) {
+	if (!multi || (!audio_bytes && audio_size > 0) || !result) {
+		return -1;
 	}
 
-	// Remove processed audio
-	if (buffer_idx > 0) {
-		memmove(features->audio_buffer,
-			features->audio_buffer + buffer_idx,
-			features->audio_buffer_size - buffer_idx);
-		features->audio_buffer_size -= buffer_idx;
+	memset(result, 0, sizeof(*result));
+	result->num_models = multi->num_models;
+
+	MultiSink sink = { multi, result, 0, 0 };
+	int status = features_generate(multi->features, audio_bytes, audio_size, SIZE_MAX,
+				       detect_frame_multi, &sink);
+	if (status < 0) {
+		return status;
+	}
+	if (sink.status < 0) {
+		return sink.status;
 	}
 
-	*features_out = all_features;
-	*features_size_out = total_features;
-	return 0;
+	return (int)sink.total;
+}
+
+MicroWakeWord *micro_wakeword_multi_get_detector(MicroWakeWordMulti *multi, size_t index) {
+	if (!multi || index >= multi->num_models) {
+		return NULL;
+	}
+	return multi->detectors[index];
+}
+
+void micro_wakeword_multi_reset(MicroWakeWordMulti *multi) {
+	if (!multi) {
+		return;
+	}
+
+	micro_wakeword_features_reset(multi->features);
+	for (size_t i = 0; i < multi->num_models; ++i) {
+		micro_wakeword_reset(multi->detectors[i]);
+	}
+}
+
+void micro_wakeword_multi_destroy(MicroWakeWordMulti *multi) {
+	if (!multi) {
+		return;
+	}
+
+	for (size_t i = 0; i < multi->num_models; ++i) {
+		micro_wakeword_destroy(multi->detectors[i]);
+	}
+	micro_wakeword_features_destroy(multi->features);
+	free(multi);
+}
+
+uint64_t micro_wakeword_features_get_sample_position(MicroWakeWordFeatures *features) {
+	return features ? features->sample_position : 0;
 }
 
 void micro_wakeword_features_reset(MicroWakeWordFeatures *features) {
@@ -701,7 +1576,32 @@ void micro_wakeword_features_reset(MicroWakeWordFeatures *features) {
 	}
 
 	micro_frontend_reset(features->frontend);
-	features->audio_buffer_size = 0;
+	features->ring_head = 0;
+	features->ring_count = 0;
+	features->sample_position = 0;
+	if (features->stats_enabled) {
+		features->stats.resets++;
+	}
+}
+
+void micro_wakeword_features_enable_stats(MicroWakeWordFeatures *features, bool enable) {
+	if (!features) {
+		return;
+	}
+	if (enable && !features->stats_enabled) {
+		memset(&features->stats, 0, sizeof(features->stats));
+	}
+	features->stats_enabled = enable;
+}
+
+int micro_wakeword_features_get_stats(MicroWakeWordFeatures *features,
+				      MicroWakeWordFeaturesStats *stats) {
+	if (!features || !stats) {
+		return -1;
+	}
+	*stats = features->stats;
+	stats->buffered_bytes = features->ring_count;
+	return 0;
 }
 
 void micro_wakeword_features_destroy(MicroWakeWordFeatures *features) {
@@ -710,6 +1610,5 @@ void micro_wakeword_features_destroy(MicroWakeWordFeatures *features) {
 	}
 
 	micro_frontend_destroy(features->frontend);
-	free(features->audio_buffer);
 	free(features);
 }
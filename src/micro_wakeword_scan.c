@@ -0,0 +1,346 @@
+// src/micro_wakeword_scan.c
+// Offline scanning of whole recordings, optionally split into segments run in parallel
+#include "micro_wakeword.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Constants
+#define SAMPLE_RATE 16000
+#define BYTES_PER_SAMPLE 2
+#define SAMPLES_PER_CHUNK 160  // 10ms @ 16kHz
+#define BLOCK_SAMPLES SAMPLE_RATE  // Audio per micro_wakeword_process_audio call
+// Less than a chunk stays buffered between blocks, so a block yields at most
+// one frame per chunk, and each frame at most one detection
+#define MAX_BLOCK_DETECTIONS (BLOCK_SAMPLES / SAMPLES_PER_CHUNK)
+#define DEFAULT_WARMUP_SECONDS 3.0f
+
+// Segment and warm-up boundaries are multiples of 12 chunks, so every
+// detector starts on the same stride phase (strides 1-4) as a straight pass.
+// The frontend's adaptive state is only approximated by the warm-up, so
+// results near segment starts can differ slightly from a straight pass;
+// that is why segmenting is opt-in.
+#define ALIGN_SAMPLES (12 * SAMPLES_PER_CHUNK)
+
+// Detections of one segment
+typedef struct {
+	MicroWakeWordDetection *items;
+	size_t count;
+	size_t capacity;
+} DetectionList;
+
+// State shared by the workers of one scan
+typedef struct {
+	const MicroWakeWordConfig *config;
+	const uint8_t *audio;
+	size_t num_samples;
+	size_t segment_samples;
+	size_t warmup_samples;
+	size_t num_segments;
+	DetectionList *results;  // One list per segment
+
+	// Protected by lock
+	pthread_mutex_t lock;
+	size_t next_segment;
+	int status;
+} ScanJob;
+
+// Round seconds to a positive multiple of ALIGN_SAMPLES
+static size_t aligned_samples(float seconds) {
+	size_t samples = (size_t)(seconds * SAMPLE_RATE);
+	samples -= samples % ALIGN_SAMPLES;
+	return samples > 0 ? samples : ALIGN_SAMPLES;
+}
+
+static int detection_list_append(DetectionList *list, const MicroWakeWordDetection *detection) {
+	if (list->count == list->capacity) {
+		size_t capacity = list->capacity ? list->capacity * 2 : 16;
+		MicroWakeWordDetection *items = (MicroWakeWordDetection *)realloc(
+			list->items, capacity * sizeof(MicroWakeWordDetection));
+		if (!items) {
+			return -1;
+		}
+		list->items = items;
+		list->capacity = capacity;
+	}
+	list->items[list->count++] = *detection;
+	return 0;
+}
+
+// Run one segment, preceded by its warm-up audio, keeping only detections
+// whose frame ends inside (start, end]
+static int scan_segment(ScanJob *job, size_t index, MicroWakeWord *mww,
+			MicroWakeWordFeatures *features) {
+	size_t start = index * job->segment_samples;
+	size_t end = start + job->segment_samples;
+	if (end > job->num_samples) {
+		end = job->num_samples;
+	}
+	size_t warm_start = start > job->warmup_samples ? start - job->warmup_samples : 0;
+
+	micro_wakeword_reset(mww);
+	micro_wakeword_features_reset(features);
+
+	MicroWakeWordDetection block[MAX_BLOCK_DETECTIONS];
+	for (size_t pos = warm_start; pos < end; pos += BLOCK_SAMPLES) {
+		size_t samples = end - pos < BLOCK_SAMPLES ? end - pos : BLOCK_SAMPLES;
+		int count = micro_wakeword_process_audio(mww, features,
+							 job->audio + pos * BYTES_PER_SAMPLE,
+							 samples * BYTES_PER_SAMPLE,
+							 block, MAX_BLOCK_DETECTIONS);
+		if (count < 0) {
+			return count;
+		}
+		if (count > MAX_BLOCK_DETECTIONS) {
+			return -4;  // Report rather than silently drop detections
+		}
+
+		// Offsets count from warm_start, where features were reset
+		for (int i = 0; i < count; ++i) {
+			MicroWakeWordDetection detection = block[i];
+			detection.sample_offset += warm_start;
+			if (detection.sample_offset > start &&
+			    detection_list_append(&job->results[index], &detection) != 0) {
+				return -3;
+			}
+		}
+	}
+
+	return 0;
+}
+
+// Worker thread: claims segments until none are left
+static void *scan_worker(void *arg) {
+	ScanJob *job = (ScanJob *)arg;
+
+	MicroWakeWord *mww = micro_wakeword_create(job->config);
+	MicroWakeWordFeatures *features = micro_wakeword_features_create();
+	int status = (mww && features) ? 0 : -2;
+
+	for (;;) {
+		pthread_mutex_lock(&job->lock);
+		if (status != 0 && job->status == 0) {
+			job->status = status;
+		}
+		size_t index = job->next_segment;
+		bool done = job->status != 0 || index >= job->num_segments;
+		if (!done) {
+			job->next_segment++;
+		}
+		pthread_mutex_unlock(&job->lock);
+
+		if (done) {
+			break;
+		}
+		status = scan_segment(job, index, mww, features);
+	}
+
+	micro_wakeword_features_destroy(features);
+	micro_wakeword_destroy(mww);
+	return NULL;
+}
+
+int micro_wakeword_scan_audio(const MicroWakeWordConfig *config,
+			      const uint8_t *audio_bytes,
+			      size_t audio_size,
+			      const MicroWakeWordScanOptions *options,
+			      MicroWakeWordDetection **detections_out,
+			      size_t *num_detections_out) {
+	if (!config || (!audio_bytes && audio_size > 0) || !detections_out ||
+	    !num_detections_out) {
+		return -1;
+	}
+
+	*detections_out = NULL;
+	*num_detections_out = 0;
+
+	MicroWakeWordScanOptions defaults = { 0, 0.0f, 0.0f };
+	if (!options) {
+		options = &defaults;
+	}
+
+	ScanJob job;
+	memset(&job, 0, sizeof(job));
+	job.config = config;
+	job.audio = audio_bytes;
+	job.num_samples = audio_size / BYTES_PER_SAMPLE;
+	// Without segment_seconds the recording is one segment: a single exact
+	// pass on one thread
+	job.segment_samples = options->segment_seconds > 0.0f
+			      ? aligned_samples(options->segment_seconds)
+			      : job.num_samples;
+	job.warmup_samples = options->warmup_seconds > 0.0f
+			     ? aligned_samples(options->warmup_seconds)
+			     : aligned_samples(DEFAULT_WARMUP_SECONDS);
+	if (job.num_samples == 0) {
+		return 0;
+	}
+	job.num_segments = (job.num_samples + job.segment_samples - 1) / job.segment_samples;
+
+	job.results = (DetectionList *)calloc(job.num_segments, sizeof(DetectionList));
+	if (!job.results) {
+		return -3;
+	}
+	pthread_mutex_init(&job.lock, NULL);
+
+	size_t num_threads = options->num_threads;
+	if (num_threads == 0) {
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		num_threads = (cpus > 0) ? (size_t)cpus : 1;
+	}
+	if (num_threads > job.num_segments) {
+		num_threads = job.num_segments;
+	}
+
+	// The calling thread is one of the workers
+	pthread_t *threads = (pthread_t *)calloc(num_threads, sizeof(pthread_t));
+	size_t started = 0;
+	if (threads) {
+		for (; started + 1 < num_threads; ++started) {
+			if (pthread_create(&threads[started], NULL, scan_worker, &job) != 0) {
+				break;
+			}
+		}
+	}
+	scan_worker(&job);
+	for (size_t i = 0; i < started; ++i) {
+		pthread_join(threads[i], NULL);
+	}
+	free(threads);
+	pthread_mutex_destroy(&job.lock);
+
+	// Concatenate the segments' detections in stream order
+	int status = job.status;
+	size_t total = 0;
+	for (size_t i = 0; i < job.num_segments; ++i) {
+		total += job.results[i].count;
+	}
+	if (status == 0 && total > 0) {
+		MicroWakeWordDetection *detections = (MicroWakeWordDetection *)malloc(
+			total * sizeof(MicroWakeWordDetection));
+		if (detections) {
+			size_t count = 0;
+			for (size_t i = 0; i < job.num_segments; ++i) {
+				memcpy(detections + count, job.results[i].items,
+				       job.results[i].count * sizeof(MicroWakeWordDetection));
+				count += job.results[i].count;
+			}
+			*detections_out = detections;
+			*num_detections_out = total;
+		} else {
+			status = -3;
+		}
+	}
+
+	for (size_t i = 0; i < job.num_segments; ++i) {
+		free(job.results[i].items);
+	}
+	free(job.results);
+	return status;
+}
+
+static uint16_t read_le16(const uint8_t *p) {
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t read_le32(const uint8_t *p) {
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+	       ((uint32_t)p[3] << 24);
+}
+
+// Locate the PCM data of a WAV file; anything else is taken as raw PCM
+// Returns 0 on success, negative for a WAV file in an unsupported format
+static int find_pcm_data(const uint8_t *file, size_t size, size_t *offset, size_t *length) {
+	if (size < 12 || memcmp(file, "RIFF", 4) != 0 || memcmp(file + 8, "WAVE", 4) != 0) {
+		*offset = 0;
+		*length = size;
+		return 0;
+	}
+
+	bool format_ok = false;
+	size_t pos = 12;
+	while (pos + 8 <= size) {
+		size_t chunk_size = read_le32(file + pos + 4);
+		const uint8_t *body = file + pos + 8;
+		size_t available = size - pos - 8;
+
+		if (memcmp(file + pos, "fmt ", 4) == 0) {
+			if (chunk_size < 16 || available < 16) {
+				return -1;
+			}
+			// PCM, mono, 16kHz, 16-bit
+			format_ok = read_le16(body) == 1 && read_le16(body + 2) == 1 &&
+				    read_le32(body + 4) == SAMPLE_RATE && read_le16(body + 14) == 16;
+			if (!format_ok) {
+				return -1;
+			}
+		} else if (memcmp(file + pos, "data", 4) == 0) {
+			if (!format_ok) {
+				return -1;
+			}
+			*offset = pos + 8;
+			*length = chunk_size < available ? chunk_size : available;
+			return 0;
+		}
+
+		if (chunk_size > available) {
+			break;
+		}
+		pos += 8 + chunk_size + (chunk_size & 1);
+	}
+
+	return -1;
+}
+
+int micro_wakeword_scan_file(const MicroWakeWordConfig *config,
+			     const char *path,
+			     const MicroWakeWordScanOptions *options,
+			     MicroWakeWordDetection **detections_out,
+			     size_t *num_detections_out) {
+	if (!config || !path || !detections_out || !num_detections_out) {
+		return -1;
+	}
+
+	*detections_out = NULL;
+	*num_detections_out = 0;
+
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return -2;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		return -2;
+	}
+	size_t size = (size_t)st.st_size;
+	if (size == 0) {
+		close(fd);
+		return 0;
+	}
+
+	void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		return -2;
+	}
+	madvise(map, size, MADV_SEQUENTIAL);
+
+	size_t offset, length;
+	int status = find_pcm_data((const uint8_t *)map, size, &offset, &length);
+	if (status == 0) {
+		status = micro_wakeword_scan_audio(config, (const uint8_t *)map + offset, length,
+						   options, detections_out, num_detections_out);
+	} else {
+		status = -4;
+	}
+
+	munmap(map, size);
+	return status;
+}
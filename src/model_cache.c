@@ -0,0 +1,246 @@
+// src/model_cache.c
+#include "model_cache.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Cached models, protected by cache_lock. cache_loaded is signalled when a
+// pending entry finishes loading.
+static CachedModel *cache = NULL;
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cache_loaded = PTHREAD_COND_INITIALIZER;
+
+// Get modification time from stat result
+static struct timespec stat_mtime(const struct stat *st) {
+#if defined(__APPLE__)
+	return st->st_mtimespec;
+#else
+	return st->st_mtim;
+#endif
+}
+
+// Check if cache entry holds the model described by source
+static int same_model(const CachedModel *cm, TfLiteRuntime *rt,
+		      const ModelSource *source, const struct stat *st) {
+	if (cm->rt != rt || cm->source.kind != source->kind) {
+		return 0;
+	}
+
+	if (source->kind == MODEL_SOURCE_BUFFER) {
+		return cm->source.data == source->data && cm->source.size == source->size;
+	}
+
+	struct timespec mtime = stat_mtime(st);
+	if (cm->dev != st->st_dev || cm->ino != st->st_ino ||
+	    cm->file_size != st->st_size || cm->mtime.tv_sec != mtime.tv_sec ||
+	    cm->mtime.tv_nsec != mtime.tv_nsec || strcmp(cm->source.path, source->path) != 0) {
+		return 0;
+	}
+
+	return source->kind != MODEL_SOURCE_MMAP ||
+	       (cm->source.offset == source->offset && cm->source.size == source->size);
+}
+
+// Map [offset, offset + size) of the file read-only. The mapping is shared,
+// so every process mapping the same file uses the same page cache pages.
+static int map_model(CachedModel *cm, const struct stat *st, const void **data, size_t *data_size) {
+	size_t size = cm->source.size;
+	if (cm->source.offset > (size_t)st->st_size) {
+		return -1;
+	}
+	if (size == 0) {
+		size = (size_t)st->st_size - cm->source.offset;
+	}
+	if (size == 0 || size > (size_t)st->st_size - cm->source.offset) {
+		return -1;
+	}
+
+	int fd = open(cm->source.path, O_RDONLY);
+	if (fd < 0) {
+		return -2;
+	}
+
+	// mmap offsets must be page aligned
+	size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+	size_t aligned_offset = cm->source.offset - cm->source.offset % page_size;
+	size_t delta = cm->source.offset - aligned_offset;
+
+	void *mapping = mmap(NULL, size + delta, PROT_READ, MAP_SHARED, fd, (off_t)aligned_offset);
+	close(fd);
+	if (mapping == MAP_FAILED) {
+		return -3;
+	}
+
+	cm->mapping = mapping;
+	cm->mapping_size = size + delta;
+	*data = (const uint8_t *)mapping + delta;
+	*data_size = size;
+	return 0;
+}
+
+// Create the TfLiteModel for a new cache entry. Runs without cache_lock, so
+// it only writes fields that lookups do not read (the key stays untouched).
+static int create_model(CachedModel *cm, const struct stat *st) {
+	const void *data = cm->source.data;
+	size_t size = cm->source.size;
+
+	switch (cm->source.kind) {
+	case MODEL_SOURCE_FILE:
+		cm->model = cm->rt->TfLiteModelCreateFromFile(cm->source.path);
+		break;
+	case MODEL_SOURCE_MMAP:
+		if (map_model(cm, st, &data, &size) != 0) {
+			return -1;
+		}
+		cm->model = cm->rt->TfLiteModelCreate(data, size);
+		break;
+	case MODEL_SOURCE_BUFFER:
+		cm->model = cm->rt->TfLiteModelCreate(data, size);
+		break;
+	}
+
+	if (!cm->model) {
+		if (cm->mapping) {
+			munmap(cm->mapping, cm->mapping_size);
+			cm->mapping = NULL;
+		}
+		return -2;
+	}
+	return 0;
+}
+
+// Free an entry that is no longer referenced or linked
+static void free_entry(CachedModel *cm) {
+	if (cm->model) {
+		cm->rt->TfLiteModelDelete(cm->model);
+	}
+	if (cm->mapping) {
+		munmap(cm->mapping, cm->mapping_size);
+	}
+	tflite_runtime_release(cm->rt);
+	free((char *)cm->source.path);
+	free(cm);
+}
+
+// Unlink an entry from the cache (cache_lock held)
+static void unlink_entry(CachedModel *cm) {
+	for (CachedModel **link = &cache; *link; link = &(*link)->next) {
+		if (*link == cm) {
+			*link = cm->next;
+			break;
+		}
+	}
+}
+
+// Drop a reference taken on an entry whose load failed
+static void release_failed(CachedModel *cm) {
+	int last = --cm->refcount == 0;
+	pthread_mutex_unlock(&cache_lock);
+	if (last) {
+		free_entry(cm);
+	}
+}
+
+CachedModel *model_cache_acquire(TfLiteRuntime *rt, const ModelSource *source) {
+	if (!rt || !source) {
+		return NULL;
+	}
+
+	struct stat st;
+	memset(&st, 0, sizeof(st));
+	if (source->kind == MODEL_SOURCE_BUFFER) {
+		if (!source->data || source->size == 0) {
+			return NULL;
+		}
+	} else if (!source->path || stat(source->path, &st) != 0) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&cache_lock);
+
+	// Reuse an already loaded model for the same source, waiting for it if
+	// another thread is still loading it
+	for (CachedModel *cm = cache; cm; cm = cm->next) {
+		if (same_model(cm, rt, source, &st)) {
+			cm->refcount++;
+			while (cm->loading) {
+				pthread_cond_wait(&cache_loaded, &cache_lock);
+			}
+			if (!cm->model) {
+				release_failed(cm);
+				return NULL;
+			}
+			pthread_mutex_unlock(&cache_lock);
+			return cm;
+		}
+	}
+
+	CachedModel *cm = (CachedModel *)calloc(1, sizeof(CachedModel));
+	if (!cm) {
+		pthread_mutex_unlock(&cache_lock);
+		return NULL;
+	}
+
+	cm->source = *source;
+	if (source->path) {
+		cm->source.path = strdup(source->path);
+		if (!cm->source.path) {
+			free(cm);
+			pthread_mutex_unlock(&cache_lock);
+			return NULL;
+		}
+	}
+
+	// Publish a pending entry so concurrent requests for the same model wait
+	// for this load instead of starting their own
+	cm->rt = tflite_runtime_retain(rt);
+	cm->dev = st.st_dev;
+	cm->ino = st.st_ino;
+	cm->file_size = st.st_size;
+	cm->mtime = stat_mtime(&st);
+	cm->refcount = 1;
+	cm->loading = 1;
+	cm->next = cache;
+	cache = cm;
+
+	// Read the file and parse the model without holding the lock, so other
+	// models can be created meanwhile
+	pthread_mutex_unlock(&cache_lock);
+	int status = create_model(cm, &st);
+	pthread_mutex_lock(&cache_lock);
+
+	cm->loading = 0;
+	pthread_cond_broadcast(&cache_loaded);
+	if (status != 0) {
+		unlink_entry(cm);
+		release_failed(cm);
+		return NULL;
+	}
+
+	pthread_mutex_unlock(&cache_lock);
+	return cm;
+}
+
+void model_cache_release(CachedModel *cm) {
+	if (!cm) {
+		return;
+	}
+
+	pthread_mutex_lock(&cache_lock);
+
+	if (--cm->refcount > 0) {
+		pthread_mutex_unlock(&cache_lock);
+		return;
+	}
+
+	unlink_entry(cm);
+	pthread_mutex_unlock(&cache_lock);
+
+	free_entry(cm);
+}
@@ -0,0 +1,54 @@
+// src/model_cache.h
+// Process-wide cache of immutable TensorFlow Lite models (internal)
+
+#ifndef MODEL_CACHE_H_
+#define MODEL_CACHE_H_
+
+#include <stddef.h>
+#include <sys/types.h>
+#include <time.h>
+
+#include "tflite_runtime.h"
+
+// Where a model's flatbuffer comes from
+typedef enum {
+	MODEL_SOURCE_FILE,    // path, loaded by TfLiteModelCreateFromFile
+	MODEL_SOURCE_MMAP,    // path + offset + size, mapped read-only and shared
+	MODEL_SOURCE_BUFFER,  // data + size, owned by the caller
+} ModelSourceKind;
+
+typedef struct {
+	ModelSourceKind kind;
+	const char *path;  // FILE, MMAP
+	const void *data;  // BUFFER
+	size_t offset;     // MMAP: byte offset of the model in the file
+	size_t size;       // MMAP: model size (0 = to end of file), BUFFER: data size
+} ModelSource;
+
+// Shared model, keyed by runtime, source and file identity
+typedef struct CachedModel {
+	struct CachedModel *next;  // Cache list
+	TfLiteRuntime *rt;         // Runtime that created the model (referenced)
+	ModelSource source;        // path is owned by the entry
+	dev_t dev;
+	ino_t ino;
+	off_t file_size;
+	struct timespec mtime;
+	void *mapping;  // MMAP: mapped region
+	size_t mapping_size;
+	size_t refcount;
+	int loading;  // Set while the model is created outside the cache lock
+	TfLiteModel model;
+} CachedModel;
+
+// Get a reference to the model described by source, loading it on first
+// use or when the backing file changed on disk. Thread-safe; the model is
+// loaded outside the cache lock, and concurrent requests for it wait for that
+// one load.
+// Returns NULL on error
+CachedModel *model_cache_acquire(TfLiteRuntime *rt, const ModelSource *source);
+
+// Release a reference; the model is deleted when the last one goes away
+void model_cache_release(CachedModel *cm);
+
+#endif  // MODEL_CACHE_H_
@@ -0,0 +1,83 @@
+// src/probability_tap.c
+// Lock-free single-producer/single-consumer ring of raw model outputs
+#include "probability_tap.h"
+#include "stats.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+int probability_tap_init(ProbabilityTap *tap, size_t capacity) {
+	memset(tap, 0, sizeof(*tap));
+	if (capacity == 0 || capacity > ((size_t)1 << 30)) {
+		return -1;
+	}
+
+	size_t size = 1;
+	while (size < capacity) {
+		size <<= 1;
+	}
+
+	tap->entries = (MicroWakeWordProbability *)malloc(size * sizeof(MicroWakeWordProbability));
+	if (!tap->entries) {
+		return -2;
+	}
+	tap->capacity = size;
+	tap->mask = size - 1;
+	return 0;
+}
+
+void probability_tap_free(ProbabilityTap *tap) {
+	free(tap->entries);
+	tap->entries = NULL;
+	tap->capacity = 0;
+	tap->mask = 0;
+}
+
+void probability_tap_push(ProbabilityTap *tap, uint64_t sample_offset, float probability) {
+	uint64_t head = tap->head;
+	uint64_t sequence = head + tap->dropped;
+
+	// Only look at the consumer's cache line when the ring seems full
+	if (head - tap->tail_cache >= tap->capacity) {
+		tap->tail_cache = __atomic_load_n(&tap->tail, __ATOMIC_ACQUIRE);
+		if (head - tap->tail_cache >= tap->capacity) {
+			__atomic_store_n(&tap->dropped, tap->dropped + 1, __ATOMIC_RELAXED);
+			return;
+		}
+	}
+
+	MicroWakeWordProbability *entry = &tap->entries[head & tap->mask];
+	entry->sequence = sequence;
+	entry->sample_offset = sample_offset;
+	entry->timestamp_ns = stats_clock_ns();
+	entry->probability = probability;
+
+	// Publish the entry
+	__atomic_store_n(&tap->head, head + 1, __ATOMIC_RELEASE);
+}
+
+size_t probability_tap_read(ProbabilityTap *tap, MicroWakeWordProbability *out,
+			    size_t max_entries) {
+	uint64_t tail = tap->tail;
+	uint64_t available = __atomic_load_n(&tap->head, __ATOMIC_ACQUIRE) - tail;
+	size_t count = available < max_entries ? (size_t)available : max_entries;
+
+	// At most two contiguous runs: up to the end of the ring, then from the start
+	size_t start = (size_t)(tail & tap->mask);
+	size_t first = tap->capacity - start < count ? tap->capacity - start : count;
+	memcpy(out, &tap->entries[start], first * sizeof(MicroWakeWordProbability));
+	memcpy(out + first, tap->entries, (count - first) * sizeof(MicroWakeWordProbability));
+
+	// Hand the slots back to the producer
+	__atomic_store_n(&tap->tail, tail + count, __ATOMIC_RELEASE);
+	return count;
+}
+
+void probability_tap_get_stats(const ProbabilityTap *tap, MicroWakeWordProbabilityTapStats *stats) {
+	uint64_t tail = __atomic_load_n(&tap->tail, __ATOMIC_ACQUIRE);
+	uint64_t head = __atomic_load_n(&tap->head, __ATOMIC_ACQUIRE);
+	stats->capacity = tap->capacity;
+	stats->written = head;
+	stats->dropped = __atomic_load_n(&tap->dropped, __ATOMIC_RELAXED);
+	stats->pending = (size_t)(head - tail);
+}
@@ -0,0 +1,51 @@
+// src/probability_tap.h
+// Lock-free single-producer/single-consumer ring of raw model outputs (internal)
+
+#ifndef PROBABILITY_TAP_H_
+#define PROBABILITY_TAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "micro_wakeword.h"
+
+// The detector's processing thread is the only producer and the thread
+// calling probability_tap_read the only consumer. head and tail count
+// entries ever written and read; each side owns one and reads the other
+// with acquire semantics, so neither side ever waits. They sit on separate
+// cache lines so the two threads do not contend for one line.
+typedef struct {
+	MicroWakeWordProbability *entries;
+	size_t capacity;  // Power of two
+	size_t mask;      // capacity - 1
+
+	// Producer side
+	uint64_t head;
+	uint64_t tail_cache;  // Last tail seen, refreshed only when the ring looks full
+	uint64_t dropped;
+	char pad[64];
+
+	// Consumer side
+	uint64_t tail;
+} ProbabilityTap;
+
+// Allocate a ring of at least capacity entries (rounded up to a power of two)
+// Returns 0 on success, negative on error
+int probability_tap_init(ProbabilityTap *tap, size_t capacity);
+
+// Free the ring
+void probability_tap_free(ProbabilityTap *tap);
+
+// Record one output stamped with the monotonic clock (producer only). When
+// the ring is full the entry is dropped and counted instead. Never blocks or
+// allocates.
+void probability_tap_push(ProbabilityTap *tap, uint64_t sample_offset, float probability);
+
+// Copy up to max_entries of the oldest entries into out and remove them
+// (consumer only). Returns the number copied.
+size_t probability_tap_read(ProbabilityTap *tap, MicroWakeWordProbability *out,
+			    size_t max_entries);
+
+// Snapshot of the counters (safe from any thread)
+void probability_tap_get_stats(const ProbabilityTap *tap, MicroWakeWordProbabilityTapStats *stats);
+
+#endif  // PROBABILITY_TAP_H_
@@ -0,0 +1,98 @@
+// src/probability_window.c
+// Sliding window of model probabilities with a constant-time mean
+#include "probability_window.h"
+
+#include <stdlib.h>
+
+int probability_window_init(ProbabilityWindow *window, size_t size) {
+	if (size == 0) {
+		return -1;
+	}
+
+	window->probabilities = (float *)malloc(size * sizeof(float));
+	window->max_slots = (size_t *)malloc(size * sizeof(size_t));
+	if (!window->probabilities || !window->max_slots) {
+		probability_window_free(window);
+		return -1;
+	}
+	window->size = size;
+	probability_window_clear(window);
+	return 0;
+}
+
+void probability_window_free(ProbabilityWindow *window) {
+	free(window->probabilities);
+	free(window->max_slots);
+	window->probabilities = NULL;
+	window->max_slots = NULL;
+}
+
+void probability_window_clear(ProbabilityWindow *window) {
+	window->count = 0;
+	window->head = 0;
+	window->sum = 0.0;
+	window->adds_since_renormalize = 0;
+	window->max_front = 0;
+	window->max_count = 0;
+}
+
+void probability_window_add(ProbabilityWindow *window, float prob) {
+	if (window->count == window->size) {
+		window->sum -= window->probabilities[window->head];
+
+		// The evicted slot leaves the deque if it is still the maximum
+		if (window->max_count > 0 && window->max_slots[window->max_front] == window->head) {
+			window->max_front = (window->max_front + 1) % window->size;
+			window->max_count--;
+		}
+	} else {
+		window->count++;
+	}
+	window->probabilities[window->head] = prob;
+
+	// Older slots no larger than prob can never be the maximum again
+	while (window->max_count > 0) {
+		size_t back = (window->max_front + window->max_count - 1) % window->size;
+		if (window->probabilities[window->max_slots[back]] > prob) {
+			break;
+		}
+		window->max_count--;
+	}
+	window->max_slots[(window->max_front + window->max_count) % window->size] = window->head;
+	window->max_count++;
+
+	window->head = (window->head + 1) % window->size;
+	window->sum += prob;
+
+	// Re-sum from scratch once per window length to drop accumulated drift
+	if (++window->adds_since_renormalize >= window->size) {
+		double sum = 0.0;
+		for (size_t i = 0; i < window->count; ++i) {
+			sum += window->probabilities[i];
+		}
+		window->sum = sum;
+		window->adds_since_renormalize = 0;
+	}
+}
+
+float probability_window_mean(const ProbabilityWindow *window) {
+	if (window->count == 0) {
+		return 0.0f;
+	}
+	return (float)(window->sum / (double)window->count);
+}
+
+float probability_window_latest(const ProbabilityWindow *window) {
+	if (window->count == 0) {
+		return 0.0f;
+	}
+	size_t latest = window->head == 0 ? window->size - 1 : window->head - 1;
+	return window->probabilities[latest];
+}
+
+float probability_window_max(const ProbabilityWindow *window) {
+	if (window->max_count == 0) {
+		return 0.0f;
+	}
+	return window->probabilities[window->max_slots[window->max_front]];
+}
@@ -0,0 +1,56 @@
+// src/probability_window.h
+// Sliding window of model probabilities with a constant-time mean (internal)
+
+#ifndef PROBABILITY_WINDOW_H_
+#define PROBABILITY_WINDOW_H_
+
+#include <stddef.h>
+
+// Circular buffer of the latest probabilities plus their running sum.
+// The sum is kept in double and recomputed from the buffer once every
+// size insertions, which bounds accumulated rounding drift while keeping
+// add and mean O(1) amortized. The mean matches a fresh float re-summation
+// of the window to within PROBABILITY_WINDOW_TOLERANCE. The maximum is kept
+// the same way with a monotonic deque of slots whose probabilities decrease
+// from front to back, so it is also O(1) amortized.
+typedef struct {
+	float *probabilities;
+	size_t size;
+	size_t count;
+	size_t head;
+	double sum;
+	size_t adds_since_renormalize;
+
+	// Deque of slots in probabilities (ring of size entries)
+	size_t *max_slots;
+	size_t max_front;
+	size_t max_count;
+} ProbabilityWindow;
+
+// Largest difference between probability_window_mean and summing the window
+// in float, for probabilities in [0, 1] and windows up to 1000 entries
+#define PROBABILITY_WINDOW_TOLERANCE 1e-4f
+
+// Allocate a window of size entries (size must be > 0)
+// Returns 0 on success, negative on error
+int probability_window_init(ProbabilityWindow *window, size_t size);
+
+// Free the window's buffer
+void probability_window_free(ProbabilityWindow *window);
+
+// Forget all probabilities
+void probability_window_clear(ProbabilityWindow *window);
+
+// Add a probability, evicting the oldest once the window is full
+void probability_window_add(ProbabilityWindow *window, float prob);
+
+// Mean of the probabilities in the window (0 if empty)
+float probability_window_mean(const ProbabilityWindow *window);
+
+// Most recently added probability (0 if empty)
+float probability_window_latest(const ProbabilityWindow *window);
+
+// Highest probability in the window (0 if empty)
+float probability_window_max(const ProbabilityWindow *window);
+
+#endif  // PROBABILITY_WINDOW_H_
@@ -0,0 +1,275 @@
+// src/quantize.c
+// Feature quantization kernels with runtime CPU dispatch
+#include "quantize.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define QUANTIZE_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) || (defined(__arm__) && defined(__ARM_NEON))
+#define QUANTIZE_NEON 1
+#include <arm_neon.h>
+#if defined(__arm__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+
+// The vector kernels multiply by 1/scale instead of dividing, which can move
+// the result by a few ulps. A lane is only trusted if it is further than
+// TIE_MARGIN (relative to its magnitude) from a rounding tie and below
+// FAST_LIMIT; otherwise its whole group is redone by the scalar kernel, so
+// the output stays bit-exact.
+#define TIE_MARGIN (1.0f / 1048576.0f)  // 2^-20
+#define FAST_LIMIT 2097152.0f           // 2^21
+
+void quantize_params_init(QuantizeParams *params, float scale, int32_t zero_point) {
+	params->scale = scale;
+	params->inv_scale = 1.0f / scale;
+	params->zero_point = (float)zero_point;
+}
+
+// Kernel bodies are inlined into a variable-width entry point and a
+// QUANTIZE_FRAME_SIZE one. The latter has a constant trip count, so the
+// compiler fully unrolls it and keeps the constants in registers.
+#define DEFINE_KERNELS(linkage, name, body, attrs) \
+	linkage attrs void name(const float *src, uint8_t *dst, size_t n, \
+			const QuantizeParams *params) { \
+		body(src, dst, n, params); \
+	} \
+	static attrs void name##_frame(const float *src, uint8_t *dst, size_t n, \
+				       const QuantizeParams *params) { \
+		(void)n; \
+		body(src, dst, QUANTIZE_FRAME_SIZE, params); \
+	}
+
+#define INLINE_BODY static inline __attribute__((always_inline))
+
+INLINE_BODY void quantize_scalar_body(const float *src, uint8_t *dst, size_t n,
+				      const QuantizeParams *params) {
+#pragma GCC unroll 8
+	for (size_t i = 0; i < n; ++i) {
+		// Match Python: np.round(...).astype(np.uint8)
+		// uint8 casting wraps negative values (e.g., -128 becomes 128)
+		float quant = roundf(src[i] / params->scale + params->zero_point);
+		// Cast directly to uint8_t - this will wrap negative values correctly
+		// e.g., -128 wraps to 128, -1 wraps to 255
+		dst[i] = (uint8_t)(int32_t)quant;
+	}
+}
+
+DEFINE_KERNELS(, quantize_scalar, quantize_scalar_body, )
+
+#if QUANTIZE_X86
+
+INLINE_BODY __attribute__((target("sse4.1")))
+void quantize_sse41_body(const float *src, uint8_t *dst, size_t n,
+			 const QuantizeParams *params) {
+	const __m128 inv_scale = _mm_set1_ps(params->inv_scale);
+	const __m128 zero_point = _mm_set1_ps(params->zero_point);
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 margin = _mm_set1_ps(TIE_MARGIN);
+	const __m128 limit = _mm_set1_ps(FAST_LIMIT);
+	const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	const __m128i byte_mask = _mm_set1_epi32(0xff);
+
+	size_t i = 0;
+#pragma GCC unroll 10
+	for (; i + 4 <= n; i += 4) {
+		__m128 y = _mm_mul_ps(_mm_loadu_ps(src + i), inv_scale);
+		__m128 v = _mm_add_ps(y, zero_point);
+
+		// Distance of the fractional part from .5 (NaN compares false)
+		__m128 abs_v = _mm_and_ps(v, abs_mask);
+		__m128 frac = _mm_sub_ps(abs_v, _mm_round_ps(abs_v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC));
+		__m128 tie_dist = _mm_and_ps(_mm_sub_ps(frac, half), abs_mask);
+		__m128 tol = _mm_mul_ps(_mm_add_ps(abs_v, _mm_and_ps(y, abs_mask)), margin);
+		__m128 ok = _mm_and_ps(_mm_cmplt_ps(abs_v, limit), _mm_cmpgt_ps(tie_dist, tol));
+		if (_mm_movemask_ps(ok) != 0xf) {
+			quantize_scalar(src + i, dst + i, 4, params);
+			continue;
+		}
+
+		// Low byte of each int32, as the (uint8_t)(int32_t) cast does
+		__m128i q = _mm_cvttps_epi32(_mm_round_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+		q = _mm_and_si128(q, byte_mask);
+		q = _mm_packus_epi32(q, q);
+		q = _mm_packus_epi16(q, q);
+		uint32_t bytes = (uint32_t)_mm_cvtsi128_si32(q);
+		memcpy(dst + i, &bytes, sizeof(bytes));
+	}
+
+	quantize_scalar_body(src + i, dst + i, n - i, params);
+}
+
+DEFINE_KERNELS(static, quantize_sse41, quantize_sse41_body, __attribute__((target("sse4.1"))))
+
+INLINE_BODY __attribute__((target("avx2")))
+void quantize_avx2_body(const float *src, uint8_t *dst, size_t n,
+			const QuantizeParams *params) {
+	const __m256 inv_scale = _mm256_set1_ps(params->inv_scale);
+	const __m256 zero_point = _mm256_set1_ps(params->zero_point);
+	const __m256 half = _mm256_set1_ps(0.5f);
+	const __m256 margin = _mm256_set1_ps(TIE_MARGIN);
+	const __m256 limit = _mm256_set1_ps(FAST_LIMIT);
+	const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+	const __m256i byte_mask = _mm256_set1_epi32(0xff);
+
+	size_t i = 0;
+#pragma GCC unroll 5
+	for (; i + 8 <= n; i += 8) {
+		__m256 y = _mm256_mul_ps(_mm256_loadu_ps(src + i), inv_scale);
+		__m256 v = _mm256_add_ps(y, zero_point);
+
+		// Distance of the fractional part from .5 (NaN compares false)
+		__m256 abs_v = _mm256_and_ps(v, abs_mask);
+		__m256 frac = _mm256_sub_ps(abs_v, _mm256_round_ps(abs_v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC));
+		__m256 tie_dist = _mm256_and_ps(_mm256_sub_ps(frac, half), abs_mask);
+		__m256 tol = _mm256_mul_ps(_mm256_add_ps(abs_v, _mm256_and_ps(y, abs_mask)), margin);
+		__m256 ok = _mm256_and_ps(_mm256_cmp_ps(abs_v, limit, _CMP_LT_OQ),
+					  _mm256_cmp_ps(tie_dist, tol, _CMP_GT_OQ));
+		if (_mm256_movemask_ps(ok) != 0xff) {
+			quantize_scalar(src + i, dst + i, 8, params);
+			continue;
+		}
+
+		// Low byte of each int32, as the (uint8_t)(int32_t) cast does
+		__m256i q = _mm256_cvttps_epi32(_mm256_round_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+		q = _mm256_and_si256(q, byte_mask);
+		__m128i words = _mm_packus_epi32(_mm256_castsi256_si128(q), _mm256_extracti128_si256(q, 1));
+		_mm_storel_epi64((__m128i *)(dst + i), _mm_packus_epi16(words, words));
+	}
+
+	quantize_scalar_body(src + i, dst + i, n - i, params);
+}
+
+DEFINE_KERNELS(static, quantize_avx2, quantize_avx2_body, __attribute__((target("avx2"))))
+
+#endif  // QUANTIZE_X86
+
+#if QUANTIZE_NEON
+
+// Quantize four lanes, returning false if any lane needs the scalar kernel
+static inline bool quantize_neon_lanes(float32x4_t x, const QuantizeParams *params,
+				       uint16x4_t *out) {
+	const float32x4_t half = vdupq_n_f32(0.5f);
+	float32x4_t y = vmulq_n_f32(x, params->inv_scale);
+	float32x4_t v = vaddq_f32(y, vdupq_n_f32(params->zero_point));
+
+	// Distance of the fractional part from .5 (NaN compares false)
+	float32x4_t abs_v = vabsq_f32(v);
+#if defined(__aarch64__)
+	float32x4_t trunc_v = vrndq_f32(abs_v);
+#else
+	float32x4_t trunc_v = vcvtq_f32_s32(vcvtq_s32_f32(abs_v));
+#endif
+	float32x4_t tie_dist = vabsq_f32(vsubq_f32(vsubq_f32(abs_v, trunc_v), half));
+	float32x4_t tol = vmulq_n_f32(vaddq_f32(abs_v, vabsq_f32(y)), TIE_MARGIN);
+	uint32x4_t ok = vandq_u32(vcltq_f32(abs_v, vdupq_n_f32(FAST_LIMIT)), vcgtq_f32(tie_dist, tol));
+	uint32x2_t ok2 = vand_u32(vget_low_u32(ok), vget_high_u32(ok));
+	if ((vget_lane_u32(ok2, 0) & vget_lane_u32(ok2, 1)) != 0xffffffffu) {
+		return false;
+	}
+
+#if defined(__aarch64__)
+	int32x4_t q = vcvtnq_s32_f32(v);
+#else
+	// Round half away from zero; no lane is at a tie here
+	uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(v), vdupq_n_u32(0x80000000u));
+	float32x4_t signed_half = vreinterpretq_f32_u32(vorrq_u32(sign, vreinterpretq_u32_f32(half)));
+	int32x4_t q = vcvtq_s32_f32(vaddq_f32(v, signed_half));
+#endif
+	// Narrowing keeps the low bits, as the (uint8_t)(int32_t) cast does
+	*out = vmovn_u32(vreinterpretq_u32_s32(q));
+	return true;
+}
+
+INLINE_BODY void quantize_neon_body(const float *src, uint8_t *dst, size_t n,
+				    const QuantizeParams *params) {
+	size_t i = 0;
+#pragma GCC unroll 5
+	for (; i + 8 <= n; i += 8) {
+		uint16x4_t lo, hi;
+		if (!quantize_neon_lanes(vld1q_f32(src + i), params, &lo) ||
+		    !quantize_neon_lanes(vld1q_f32(src + i + 4), params, &hi)) {
+			quantize_scalar(src + i, dst + i, 8, params);
+			continue;
+		}
+		vst1_u8(dst + i, vmovn_u16(vcombine_u16(lo, hi)));
+	}
+
+	quantize_scalar_body(src + i, dst + i, n - i, params);
+}
+
+DEFINE_KERNELS(static, quantize_neon, quantize_neon_body, )
+
+#endif  // QUANTIZE_NEON
+
+// Kernels in order of preference
+typedef struct {
+	const char *name;
+	QuantizeFunc func;
+	QuantizeFunc frame_func;  // QUANTIZE_FRAME_SIZE features only
+} QuantizeKernel;
+
+static pthread_once_t kernel_once = PTHREAD_ONCE_INIT;
+static QuantizeKernel kernels[4];
+static size_t num_kernels = 0;
+
+static void detect_kernels(void) {
+#if QUANTIZE_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		kernels[num_kernels++] = (QuantizeKernel){ "avx2", quantize_avx2, quantize_avx2_frame };
+	}
+	if (__builtin_cpu_supports("sse4.1")) {
+		kernels[num_kernels++] = (QuantizeKernel){ "sse4.1", quantize_sse41, quantize_sse41_frame };
+	}
+#elif QUANTIZE_NEON && defined(__aarch64__)
+	kernels[num_kernels++] = (QuantizeKernel){ "neon", quantize_neon, quantize_neon_frame };
+#elif QUANTIZE_NEON
+	if (getauxval(AT_HWCAP) & HWCAP_NEON) {
+		kernels[num_kernels++] = (QuantizeKernel){ "neon", quantize_neon, quantize_neon_frame };
+	}
+#endif
+	kernels[num_kernels++] = (QuantizeKernel){ "scalar", quantize_scalar, quantize_scalar_frame };
+}
+
+QuantizeFunc quantize_select(void) {
+	pthread_once(&kernel_once, detect_kernels);
+	return kernels[0].func;
+}
+
+QuantizeFunc quantize_select_frame(size_t n) {
+	pthread_once(&kernel_once, detect_kernels);
+	return n == QUANTIZE_FRAME_SIZE ? kernels[0].frame_func : kernels[0].func;
+}
+
+const char *quantize_kernel_name(void) {
+	pthread_once(&kernel_once, detect_kernels);
+	return kernels[0].name;
+}
+
+size_t quantize_available_kernels(QuantizeFunc *funcs, const char **names, size_t max) {
+	pthread_once(&kernel_once, detect_kernels);
+	size_t count = num_kernels < max ? num_kernels : max;
+	for (size_t i = 0; i < count; ++i) {
+		funcs[i] = kernels[i].func;
+		names[i] = kernels[i].name;
+	}
+	return count;
+}
+
+size_t quantize_available_frame_kernels(QuantizeFunc *funcs, const char **names, size_t max) {
+	pthread_once(&kernel_once, detect_kernels);
+	size_t count = num_kernels < max ? num_kernels : max;
+	for (size_t i = 0; i < count; ++i) {
+		funcs[i] = kernels[i].frame_func;
+		names[i] = kernels[i].name;
+	}
+	return count;
+}
@@ -0,0 +1,49 @@
+// src/quantize.h
+// Feature quantization kernels with runtime CPU dispatch (internal)
+
+#ifndef QUANTIZE_H_
+#define QUANTIZE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Frame width with a dedicated, fully unrolled kernel
+#define QUANTIZE_FRAME_SIZE 40
+
+// Quantization parameters of the model's input tensor
+typedef struct {
+	float scale;
+	float inv_scale;   // 1 / scale
+	float zero_point;
+} QuantizeParams;
+
+// Quantize n features into dst, bit-exact with
+// (uint8_t)(int32_t)roundf(src[i] / scale + zero_point)
+typedef void (*QuantizeFunc)(const float *src, uint8_t *dst, size_t n,
+			     const QuantizeParams *params);
+
+// Fill in params for an input tensor's scale and zero point
+void quantize_params_init(QuantizeParams *params, float scale, int32_t zero_point);
+
+// Reference kernel
+void quantize_scalar(const float *src, uint8_t *dst, size_t n, const QuantizeParams *params);
+
+// Fastest kernel supported by this CPU (detected once per process)
+QuantizeFunc quantize_select(void);
+
+// Fastest kernel for quantizing n features at a time. For
+// n == QUANTIZE_FRAME_SIZE this is a fixed-width variant that ignores its
+// n argument.
+QuantizeFunc quantize_select_frame(size_t n);
+
+// Name of the kernel returned by quantize_select, for diagnostics
+const char *quantize_kernel_name(void);
+
+// Every kernel this CPU supports, fastest first and ending with the scalar
+// reference (for tests). Returns the number written, at most max.
+size_t quantize_available_kernels(QuantizeFunc *funcs, const char **names, size_t max);
+
+// Fixed-width counterparts of quantize_available_kernels, in the same order
+size_t quantize_available_frame_kernels(QuantizeFunc *funcs, const char **names, size_t max);
+
+#endif  // QUANTIZE_H_
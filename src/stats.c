@@ -0,0 +1,20 @@
+// src/stats.c
+// Timing helpers for the opt-in performance counters
+#include "stats.h"
+
+#include <time.h>
+
+uint64_t stats_clock_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void stats_stage_record(MicroWakeWordStageStats *stage, uint64_t start_ns) {
+	uint64_t elapsed = stats_clock_ns() - start_ns;
+	stage->count++;
+	stage->total_ns += elapsed;
+	if (elapsed > stage->max_ns) {
+		stage->max_ns = elapsed;
+	}
+}
@@ -0,0 +1,16 @@
+// src/stats.h
+// Timing helpers for the opt-in performance counters (internal)
+
+#ifndef STATS_H_
+#define STATS_H_
+
+#include <stdint.h>
+#include "micro_wakeword.h"
+
+// Current CLOCK_MONOTONIC time in nanoseconds
+uint64_t stats_clock_ns(void);
+
+// Record one run of a stage that started at start_ns
+void stats_stage_record(MicroWakeWordStageStats *stage, uint64_t start_ns);
+
+#endif  // STATS_H_
@@ -0,0 +1,196 @@
+// src/tflite_runtime.c
+#include "tflite_runtime.h"
+
+#include <dlfcn.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Loaded runtimes, protected by registry_lock
+static TfLiteRuntime *registry = NULL;
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Helper function to find tensorflowlite_c library
+static const char *find_tflite_lib(const char *user_path) {
+	if (user_path && user_path[0] != '\0') {
+		return user_path;
+	}
+
+	// Try relative paths for development builds
+	static const char *dev_paths[] = {
+		"../lib/linux_amd64/libtensorflowlite_c.so",
+		"../lib/linux_arm64/libtensorflowlite_c.so",
+		"../lib/linux_armv7/libtensorflowlite_c.so",
+		"./libtensorflowlite_c.so",
+		NULL
+	};
+
+	for (size_t i = 0; dev_paths[i]; ++i) {
+		FILE *f = fopen(dev_paths[i], "r");
+		if (f) {
+			fclose(f);
+			return dev_paths[i];
+		}
+	}
+
+	// Return system library name - dlopen will search standard paths
+	// (LD_LIBRARY_PATH, /usr/lib, /lib, etc.)
+	return "libtensorflowlite_c.so";
+}
+
+// Load TensorFlow Lite C API functions
+static int load_tflite_functions(TfLiteRuntime *rt, const char *lib) {
+	rt->handle = dlopen(lib, RTLD_LAZY | RTLD_GLOBAL);
+	if (!rt->handle) {
+		return -2;
+	}
+
+	// Load function pointers
+	rt->TfLiteModelCreate = (TfLiteModelCreateFunc)
+		dlsym(rt->handle, "TfLiteModelCreate");
+	rt->TfLiteModelCreateFromFile = (TfLiteModelCreateFromFileFunc)
+		dlsym(rt->handle, "TfLiteModelCreateFromFile");
+	rt->TfLiteInterpreterCreate = (TfLiteInterpreterCreateFunc)
+		dlsym(rt->handle, "TfLiteInterpreterCreate");
+	rt->TfLiteInterpreterAllocateTensors = (TfLiteInterpreterAllocateTensorsFunc)
+		dlsym(rt->handle, "TfLiteInterpreterAllocateTensors");
+	rt->TfLiteInterpreterInvoke = (TfLiteInterpreterInvokeFunc)
+		dlsym(rt->handle, "TfLiteInterpreterInvoke");
+	rt->TfLiteInterpreterGetInputTensor = (TfLiteInterpreterGetInputTensorFunc)
+		dlsym(rt->handle, "TfLiteInterpreterGetInputTensor");
+	rt->TfLiteInterpreterGetOutputTensor = (TfLiteInterpreterGetOutputTensorFunc)
+		dlsym(rt->handle, "TfLiteInterpreterGetOutputTensor");
+	rt->TfLiteTensorByteSize = (TfLiteTensorByteSizeFunc)
+		dlsym(rt->handle, "TfLiteTensorByteSize");
+	rt->TfLiteTensorNumDims = (TfLiteTensorNumDimsFunc)
+		dlsym(rt->handle, "TfLiteTensorNumDims");
+	rt->TfLiteTensorDim = (TfLiteTensorDimFunc)
+		dlsym(rt->handle, "TfLiteTensorDim");
+	rt->TfLiteTensorQuantizationParams = (TfLiteTensorQuantizationParamsFunc)
+		dlsym(rt->handle, "TfLiteTensorQuantizationParams");
+	rt->TfLiteTensorCopyFromBuffer = (TfLiteTensorCopyFromBufferFunc)
+		dlsym(rt->handle, "TfLiteTensorCopyFromBuffer");
+	rt->TfLiteTensorCopyToBuffer = (TfLiteTensorCopyToBufferFunc)
+		dlsym(rt->handle, "TfLiteTensorCopyToBuffer");
+	rt->TfLiteInterpreterDelete = (TfLiteInterpreterDeleteFunc)
+		dlsym(rt->handle, "TfLiteInterpreterDelete");
+	rt->TfLiteModelDelete = (TfLiteModelDeleteFunc)
+		dlsym(rt->handle, "TfLiteModelDelete");
+
+	// Check if all functions loaded
+	if (!rt->TfLiteModelCreate || !rt->TfLiteModelCreateFromFile || !rt->TfLiteInterpreterCreate ||
+	    !rt->TfLiteInterpreterAllocateTensors || !rt->TfLiteInterpreterInvoke ||
+	    !rt->TfLiteInterpreterGetInputTensor || !rt->TfLiteInterpreterGetOutputTensor ||
+	    !rt->TfLiteTensorByteSize || !rt->TfLiteTensorNumDims || !rt->TfLiteTensorDim ||
+	    !rt->TfLiteTensorQuantizationParams ||
+	    !rt->TfLiteTensorCopyFromBuffer || !rt->TfLiteTensorCopyToBuffer ||
+	    !rt->TfLiteInterpreterDelete || !rt->TfLiteModelDelete) {
+		dlclose(rt->handle);
+		rt->handle = NULL;
+		return -3;
+	}
+
+	// Optional functions used for fast reset
+	rt->TfLiteInterpreterGetVariableTensorCount = (TfLiteInterpreterGetVariableTensorCountFunc)
+		dlsym(rt->handle, "TfLiteInterpreterGetVariableTensorCount");
+	rt->TfLiteInterpreterGetVariableTensor = (TfLiteInterpreterGetVariableTensorFunc)
+		dlsym(rt->handle, "TfLiteInterpreterGetVariableTensor");
+	rt->TfLiteInterpreterGetTensor = (TfLiteInterpreterGetTensorFunc)
+		dlsym(rt->handle, "TfLiteInterpreterGetTensor");
+	rt->TfLiteTensorType = (TfLiteTensorTypeFunc)
+		dlsym(rt->handle, "TfLiteTensorType");
+	rt->TfLiteTensorData = (TfLiteTensorDataFunc)
+		dlsym(rt->handle, "TfLiteTensorData");
+
+	// Optional functions used for interpreter options
+	rt->TfLiteInterpreterOptionsCreate = (TfLiteInterpreterOptionsCreateFunc)
+		dlsym(rt->handle, "TfLiteInterpreterOptionsCreate");
+	rt->TfLiteInterpreterOptionsDelete = (TfLiteInterpreterOptionsDeleteFunc)
+		dlsym(rt->handle, "TfLiteInterpreterOptionsDelete");
+	rt->TfLiteInterpreterOptionsSetNumThreads = (TfLiteInterpreterOptionsSetNumThreadsFunc)
+		dlsym(rt->handle, "TfLiteInterpreterOptionsSetNumThreads");
+	rt->TfLiteInterpreterOptionsAddDelegate = (TfLiteInterpreterOptionsAddDelegateFunc)
+		dlsym(rt->handle, "TfLiteInterpreterOptionsAddDelegate");
+	rt->TfLiteXNNPackDelegateOptionsDefault = (TfLiteXNNPackDelegateOptionsDefaultFunc)
+		dlsym(rt->handle, "TfLiteXNNPackDelegateOptionsDefault");
+	rt->TfLiteXNNPackDelegateCreate = (TfLiteXNNPackDelegateCreateFunc)
+		dlsym(rt->handle, "TfLiteXNNPackDelegateCreate");
+	rt->TfLiteXNNPackDelegateDelete = (TfLiteXNNPackDelegateDeleteFunc)
+		dlsym(rt->handle, "TfLiteXNNPackDelegateDelete");
+
+	return 0;
+}
+
+TfLiteRuntime *tflite_runtime_acquire(const char *lib_path) {
+	const char *lib = find_tflite_lib(lib_path);
+	if (!lib) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&registry_lock);
+
+	// Reuse an already loaded runtime for the same path
+	for (TfLiteRuntime *rt = registry; rt; rt = rt->next) {
+		if (strcmp(rt->lib_path, lib) == 0) {
+			rt->refcount++;
+			pthread_mutex_unlock(&registry_lock);
+			return rt;
+		}
+	}
+
+	TfLiteRuntime *rt = (TfLiteRuntime *)calloc(1, sizeof(TfLiteRuntime));
+	if (!rt) {
+		pthread_mutex_unlock(&registry_lock);
+		return NULL;
+	}
+
+	rt->lib_path = strdup(lib);
+	if (!rt->lib_path || load_tflite_functions(rt, lib) != 0) {
+		free(rt->lib_path);
+		free(rt);
+		pthread_mutex_unlock(&registry_lock);
+		return NULL;
+	}
+
+	rt->refcount = 1;
+	rt->next = registry;
+	registry = rt;
+
+	pthread_mutex_unlock(&registry_lock);
+	return rt;
+}
+
+TfLiteRuntime *tflite_runtime_retain(TfLiteRuntime *rt) {
+	pthread_mutex_lock(&registry_lock);
+	rt->refcount++;
+	pthread_mutex_unlock(&registry_lock);
+	return rt;
+}
+
+void tflite_runtime_release(TfLiteRuntime *rt) {
+	if (!rt) {
+		return;
+	}
+
+	pthread_mutex_lock(&registry_lock);
+
+	if (--rt->refcount > 0) {
+		pthread_mutex_unlock(&registry_lock);
+		return;
+	}
+
+	// Unlink from registry
+	for (TfLiteRuntime **link = &registry; *link; link = &(*link)->next) {
+		if (*link == rt) {
+			*link = rt->next;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&registry_lock);
+
+	dlclose(rt->handle);
+	free(rt->lib_path);
+	free(rt);
+}
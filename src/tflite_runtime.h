@@ -0,0 +1,112 @@
+// src/tflite_runtime.h
+// Process-wide TensorFlow Lite C runtime loaded through dlopen (internal)
+
+#ifndef TFLITE_RUNTIME_H_
+#define TFLITE_RUNTIME_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TFLITE_TYPE_RESOURCE 14  // kTfLiteResource
+
+// TensorFlow Lite C API types
+typedef int TfLiteStatus;  // kTfLiteOk == 0
+typedef void *TfLiteModel;
+typedef void *TfLiteInterpreter;
+typedef void *TfLiteTensor;
+typedef void *TfLiteInterpreterOptions;
+typedef void *TfLiteDelegate;
+
+// TfLiteXNNPackDelegateOptions grows between releases, so it is handled as
+// opaque storage large enough for any of them; num_threads has always been
+// its first member
+typedef struct {
+	int32_t num_threads;
+	uint8_t reserved[252];
+} __attribute__((aligned(16))) TfLiteXNNPackDelegateOptions;
+
+typedef struct {
+	float scale;
+	int32_t zero_point;
+} TfLiteQuantizationParams;
+
+// TensorFlow Lite C API function pointers
+typedef TfLiteModel (*TfLiteModelCreateFunc)(const void *, size_t);
+typedef TfLiteModel (*TfLiteModelCreateFromFileFunc)(const char *);
+typedef TfLiteInterpreter (*TfLiteInterpreterCreateFunc)(TfLiteModel, void *);
+typedef TfLiteStatus (*TfLiteInterpreterAllocateTensorsFunc)(TfLiteInterpreter);
+typedef TfLiteStatus (*TfLiteInterpreterInvokeFunc)(TfLiteInterpreter);
+typedef TfLiteTensor (*TfLiteInterpreterGetInputTensorFunc)(TfLiteInterpreter, int32_t);
+typedef TfLiteTensor (*TfLiteInterpreterGetOutputTensorFunc)(TfLiteInterpreter, int32_t);
+typedef size_t (*TfLiteTensorByteSizeFunc)(TfLiteTensor);
+typedef int32_t (*TfLiteTensorNumDimsFunc)(TfLiteTensor);
+typedef int32_t (*TfLiteTensorDimFunc)(TfLiteTensor, int32_t);
+typedef TfLiteQuantizationParams (*TfLiteTensorQuantizationParamsFunc)(TfLiteTensor);
+typedef TfLiteStatus (*TfLiteTensorCopyFromBufferFunc)(TfLiteTensor, const void *, size_t);
+typedef TfLiteStatus (*TfLiteTensorCopyToBufferFunc)(TfLiteTensor, void *, size_t);
+typedef void (*TfLiteInterpreterDeleteFunc)(TfLiteInterpreter);
+typedef void (*TfLiteModelDeleteFunc)(TfLiteModel);
+typedef int32_t (*TfLiteInterpreterGetVariableTensorCountFunc)(TfLiteInterpreter);
+typedef TfLiteTensor (*TfLiteInterpreterGetVariableTensorFunc)(TfLiteInterpreter, int32_t);
+typedef TfLiteTensor (*TfLiteInterpreterGetTensorFunc)(TfLiteInterpreter, int32_t);
+typedef int (*TfLiteTensorTypeFunc)(TfLiteTensor);
+typedef void *(*TfLiteTensorDataFunc)(TfLiteTensor);
+typedef TfLiteInterpreterOptions (*TfLiteInterpreterOptionsCreateFunc)(void);
+typedef void (*TfLiteInterpreterOptionsDeleteFunc)(TfLiteInterpreterOptions);
+typedef void (*TfLiteInterpreterOptionsSetNumThreadsFunc)(TfLiteInterpreterOptions, int32_t);
+typedef void (*TfLiteInterpreterOptionsAddDelegateFunc)(TfLiteInterpreterOptions, TfLiteDelegate);
+typedef TfLiteXNNPackDelegateOptions (*TfLiteXNNPackDelegateOptionsDefaultFunc)(void);
+typedef TfLiteDelegate (*TfLiteXNNPackDelegateCreateFunc)(const TfLiteXNNPackDelegateOptions *);
+typedef void (*TfLiteXNNPackDelegateDeleteFunc)(TfLiteDelegate);
+
+// Loaded runtime: one per library path, shared by all detectors
+typedef struct TfLiteRuntime {
+	struct TfLiteRuntime *next;  // Registry list
+	char *lib_path;
+	size_t refcount;
+	void *handle;  // dlopen handle for tensorflowlite_c
+
+	// Function pointers
+	TfLiteModelCreateFunc TfLiteModelCreate;
+	TfLiteModelCreateFromFileFunc TfLiteModelCreateFromFile;
+	TfLiteInterpreterCreateFunc TfLiteInterpreterCreate;
+	TfLiteInterpreterAllocateTensorsFunc TfLiteInterpreterAllocateTensors;
+	TfLiteInterpreterInvokeFunc TfLiteInterpreterInvoke;
+	TfLiteInterpreterGetInputTensorFunc TfLiteInterpreterGetInputTensor;
+	TfLiteInterpreterGetOutputTensorFunc TfLiteInterpreterGetOutputTensor;
+	TfLiteTensorByteSizeFunc TfLiteTensorByteSize;
+	TfLiteTensorNumDimsFunc TfLiteTensorNumDims;
+	TfLiteTensorDimFunc TfLiteTensorDim;
+	TfLiteTensorQuantizationParamsFunc TfLiteTensorQuantizationParams;
+	TfLiteTensorCopyFromBufferFunc TfLiteTensorCopyFromBuffer;
+	TfLiteTensorCopyToBufferFunc TfLiteTensorCopyToBuffer;
+	TfLiteInterpreterDeleteFunc TfLiteInterpreterDelete;
+	TfLiteModelDeleteFunc TfLiteModelDelete;
+
+	// Optional function pointers (NULL if missing from the runtime)
+	TfLiteInterpreterGetVariableTensorCountFunc TfLiteInterpreterGetVariableTensorCount;
+	TfLiteInterpreterGetVariableTensorFunc TfLiteInterpreterGetVariableTensor;
+	TfLiteInterpreterGetTensorFunc TfLiteInterpreterGetTensor;
+	TfLiteTensorTypeFunc TfLiteTensorType;
+	TfLiteTensorDataFunc TfLiteTensorData;
+	TfLiteInterpreterOptionsCreateFunc TfLiteInterpreterOptionsCreate;
+	TfLiteInterpreterOptionsDeleteFunc TfLiteInterpreterOptionsDelete;
+	TfLiteInterpreterOptionsSetNumThreadsFunc TfLiteInterpreterOptionsSetNumThreads;
+	TfLiteInterpreterOptionsAddDelegateFunc TfLiteInterpreterOptionsAddDelegate;
+	TfLiteXNNPackDelegateOptionsDefaultFunc TfLiteXNNPackDelegateOptionsDefault;
+	TfLiteXNNPackDelegateCreateFunc TfLiteXNNPackDelegateCreate;
+	TfLiteXNNPackDelegateDeleteFunc TfLiteXNNPackDelegateDelete;
+} TfLiteRuntime;
+
+// Get a reference to the runtime for lib_path (NULL for default search),
+// loading it on first use. Thread-safe.
+// Returns NULL on error
+TfLiteRuntime *tflite_runtime_acquire(const char *lib_path);
+
+// Take an additional reference to an already acquired runtime
+TfLiteRuntime *tflite_runtime_retain(TfLiteRuntime *rt);
+
+// Release a reference; the library is closed when the last one goes away
+void tflite_runtime_release(TfLiteRuntime *rt);
+
+#endif  // TFLITE_RUNTIME_H_
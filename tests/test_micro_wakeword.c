@@ -5,13 +5,49 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
 #include "micro_wakeword.h"
 #include "wav_reader.h"
+#include "src/quantize.h"
+#include "src/probability_window.h"
+#include "src/tflite_runtime.h"
 
 #define BYTES_PER_CHUNK (160 * 2)  // 10ms @ 16kHz (16-bit mono)
 #define SAMPLES_PER_CHUNK 160
 #define FEATURES_PER_WINDOW 40
 
+// Heap allocation counting (test binary is linked with -Wl,--wrap=malloc etc.)
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+static size_t alloc_count = 0;
+
+void *__wrap_malloc(size_t size) {
+	alloc_count++;
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size) {
+	alloc_count++;
+	return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+	alloc_count++;
+	return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr) {
+	if (ptr) {
+		alloc_count++;
+	}
+	__real_free(ptr);
+}
+
 // Helper to find model file
 static const char *find_model_file(const char *model_name) {
 	static char path[512];
@@ -35,39 +71,1894 @@ static const char *find_model_file(const char *model_name) {
 		}
 	}
 
-	return NULL;
+	return NULL;
+}
+
+// Helper to find tensorflowlite_c library (for development only)
+// On installed systems, rely on system loader to find it in standard paths
+static const char *find_tflite_lib(void) {
+	// Only check relative paths for development builds
+	// On installed systems, return NULL to let system loader find it
+	const char *paths[] = {
+		"lib/linux_amd64/libtensorflowlite_c.so",
+		"lib/linux_arm64/libtensorflowlite_c.so",
+		"lib/linux_armv7/libtensorflowlite_c.so",
+		"../lib/linux_amd64/libtensorflowlite_c.so",
+		"../lib/linux_arm64/libtensorflowlite_c.so",
+		"../lib/linux_armv7/libtensorflowlite_c.so",
+		NULL
+	};
+
+	for (size_t i = 0; paths[i]; ++i) {
+		FILE *f = fopen(paths[i], "r");
+		if (f) {
+			fclose(f);
+			return paths[i];
+		}
+	}
+
+	// Return NULL to let system loader find it (dlopen will search LD_LIBRARY_PATH, /usr/lib, etc.)
+	return NULL;
+}
+
+// Test basic creation and destruction
+static int test_create_destroy(void) {
+	printf("Running test_create_destroy...\n");
+
+	const char *model_path = find_model_file("okay_nabu");
+	if (!model_path) {
+		printf("  SKIPPED: Model file not found\n");
+		return 0;
+	}
+
+	const char *lib_path = find_tflite_lib();
+
+	MicroWakeWordConfig config = {
+		.model_path = model_path,
+		.libtensorflowlite_c = lib_path,
+		.probability_cutoff = 0.97f,
+		.sliding_window_size = 5
+	};
+
+	MicroWakeWord *mww = micro_wakeword_create(&config);
+	if (!mww) {
+		fprintf(stderr, "Failed to create wake word detector\n");
+		return 1;
+	}
+
+	micro_wakeword_destroy(mww);
+
+	// Test features
+	MicroWakeWordFeatures *features = micro_wakeword_features_create();
+	if (!features) {
+		fprintf(stderr, "Failed to create feature generator\n");
+		return 1;
+	}
+
+	micro_wakeword_features_destroy(features);
+
+	printf("  test_create_destroy: PASSED\n");
+	return 0;
+}
+
+// Test that detectors sharing the runtime outlive each other correctly
+static int test_shared_runtime(void) {
+	printf("Running test_shared_runtime...\n");
+
+	const char *model_path = find_model_file("okay_nabu");
+	if (!model_path) {
+		printf("  SKIPPED: Model file not found\n");
+		return 0;
+	}
+
+	const char *lib_path = find_tflite_lib();
+
+	MicroWakeWordConfig config = {
+		.model_path = model_path,
+		.libtensorflowlite_c = lib_path,
+		.probability_cutoff = 0.97f,
+		.sliding_window_size = 5
+	};
+
+	MicroWakeWord *first = micro_wakeword_create(&config);
+	MicroWakeWord *second = micro_wakeword_create(&config);
+	if (!first || !second) {
+		fprintf(stderr, "Failed to create wake word detectors\n");
+		micro_wakeword_destroy(first);
+		micro_wakeword_destroy(second);
+		return 1;
+	}
+
+	// Releasing the first reference must keep the runtime loaded
+	micro_wakeword_destroy(first);
+
+	float frame[FEATURES_PER_WINDOW] = {0};
+	for (size_t i = 0; i < 10; ++i) {
+		micro_wakeword_process_streaming(second, frame, FEATURES_PER_WINDOW);
+	}
+	size_t count = micro_wakeword_get_probabilities(second, NULL, NULL);
+	micro_wakeword_destroy(second);
+
+	if (count == 0) {
+		fprintf(stderr, "No inference ran on the remaining detector\n");
+		return 1;
+	}
+
+	// Runtime must load again after the last reference was dropped
+	MicroWakeWord *third = micro_wakeword_create(&config);
+	if (!third) {
+		fprintf(stderr, "Failed to recreate wake word detector\n");
+		return 1;
+	}
+	micro_wakeword_destroy(third);
+
+	printf("  test_shared_runtime: PASSED\n");
+	return 0;
+}
+
+// Test that detectors sharing a model keep independent streaming state
+static int test_shared_model(void) {
+	printf("Running test_shared_model...\n");
+
+	const char *model_path = find_model_file("okay_nabu");
+	if (!model_path) {
+		printf("  SKIPPED: Model file not found\n");
+		return 0;
+	}
+
+	const char *lib_path = find_tflite_lib();
+
+	MicroWakeWordConfig config = {
+		.model_path = model_path,
+		.libtensorflowlite_c = lib_path,
+		.probability_cutoff = 0.97f,
+		.sliding_window_size = 5
+	};
+
+	MicroWakeWord *first = micro_wakeword_create(&config);
+	MicroWakeWord *second = micro_wakeword_create(&config);
+	if (!first || !second) {
+		fprintf(stderr, "Failed to create wake word detectors\n");
+		micro_wakeword_destroy(first);
+		micro_wakeword_destroy(second);
+		return 1;
+	}
+
+	// Run the first detector to completion, then the second on the same frames
+	enum { NUM_FRAMES = 60 };
+	float probs[2][NUM_FRAMES];
+	float frame[FEATURES_PER_WINDOW];
+	MicroWakeWord *detectors[2] = {first, second};
+
+	for (size_t d = 0; d < 2; ++d) {
+		for (size_t n = 0; n < NUM_FRAMES; ++n) {
+			for (size_t i = 0; i < FEATURES_PER_WINDOW; ++i) {
+				frame[i] = (float)((n * 5 + i * 11) % 26);
+			}
+			micro_wakeword_process_streaming(detectors[d], frame, FEATURES_PER_WINDOW);
+			micro_wakeword_get_probabilities(detectors[d], &probs[d][n], NULL);
+		}
+	}
+
+	micro_wakeword_destroy(first);
+	micro_wakeword_destroy(second);
+
+	if (memcmp(probs[0], probs[1], sizeof(probs[0])) != 0) {
+		fprintf(stderr, "Detectors sharing a model interfered with each other\n");
+		return 1;
+	}
+
+	printf("  test_shared_model: PASSED\n");
+	return 0;
+}
+
+// Read whole file into a malloc'd buffer
+static uint8_t *read_file(const char *path, size_t *size_out) {
+	FILE *f = fopen(path, "rb");
+	if (!f) {
+		return NULL;
+	}
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	uint8_t *data = (uint8_t *)malloc((size_t)size);
+	if (data && fread(data, 1, (size_t)size, f) != (size_t)size) {
+		free(data);
+		data = NULL;
+	}
+	fclose(f);
+	*size_out = (size_t)size;
+	return data;
+}
+
+// Test creating detectors from memory and from a packed, memory-mapped file
+static int test_create_from_memory(void) {
+	printf("Running test_create_from_memory...\n");
+
+	const char *model_path = find_model_file("okay_nabu");
+	if (!model_path) {
+		printf("  SKIPPED: Model file not found\n");
+		return 0;
+	}
+
+	const char *lib_path = find_tflite_lib();
+
+	MicroWakeWordConfig config = {
+		.model_path = model_path,
+		.libtensorflowlite_c = lib_path,
+		.probability_cutoff = 0.97f,
+		.sliding_window_size = 5
+	};
+
+	size_t model_size = 0;
+	uint8_t *model_data = read_file(model_path, &model_size);
+	if (!model_data) {
+		fprintf(stderr, "Failed to read model file\n");
+		return 1;
+	}
+
+	// Pack the model behind a 64-byte header, like an asset bundle
+	enum { PACK_OFFSET = 64 };
+	char pack_path[] = "/tmp/micro_wakeword_pack_XXXXXX";
+	int fd = mkstemp(pack_path);
+	uint8_t header[PACK_OFFSET] = {0};
+	if (fd < 0 || write(fd, header, sizeof(header)) != (ssize_t)sizeof(header) ||
+	    write(fd, model_data, model_size) != (ssize_t)model_size) {
+		fprintf(stderr, "Failed to write packed model\n");
+		if (fd >= 0) {
+			close(fd);
+			unlink(pack_path);
+		}
+		free(model_data);
+		return 1;
+	}
+	close(fd);
+
+	MicroWakeWord *detectors[3] = {
+		micro_wakeword_create(&config),
+		micro_wakeword_create_from_buffer(&config, model_data, model_size),
+		micro_wakeword_create_from_mmap(&config, pack_path, PACK_OFFSET, model_size),
+	};
+
+	int failed = 0;
+	if (!detectors[0] || !detectors[1] || !detectors[2]) {
+		fprintf(stderr, "Failed to create wake word detectors\n");
+		failed = 1;
+	}
+
+	// All three must produce the same probabilities
+	enum { NUM_FRAMES = 30 };
+	float probs[3][NUM_FRAMES];
+	float frame[FEATURES_PER_WINDOW];
+
+	for (size_t d = 0; d < 3 && !failed; ++d) {
+		for (size_t n = 0; n < NUM_FRAMES; ++n) {
+			for (size_t i = 0; i < FEATURES_PER_WINDOW; ++i) {
+				frame[i] = (float)((n * 3 + i * 7) % 26);
+			}
+			micro_wakeword_process_streaming(detectors[d], frame, FEATURES_PER_WINDOW);
+			micro_wakeword_get_probabilities(detectors[d], &probs[d][n], NULL);
+		}
+	}
+
+	if (!failed && (memcmp(probs[0], probs[1], sizeof(probs[0])) != 0 ||
+			memcmp(probs[0], probs[2], sizeof(probs[0])) != 0)) {
+		fprintf(stderr, "Probabilities differ between model sources\n");
+		failed = 1;
+	}
+
+	for (size_t d = 0; d < 3; ++d) {
+		micro_wakeword_destroy(detectors[d]);
+	}
+	unlink(pack_path);
+	free(model_data);
+
+	if (failed) {
+		return 1;
+	}
+
+	printf("  test_create_from_memory: PASSED\n");
+	return 0;
+}
+
+// Thread state for test_concurrent_create
+typedef struct {
+	const MicroWakeWordConfig *config;
+	const uint8_t *garbage;
+	size_t garbage_size;
+	MicroWakeWord *mww;
+	MicroWakeWord *invalid;
+} CreateThread;
+
+static void *create_thread(void *arg) {
+	CreateThread *t = (CreateThread *)arg;
+	t->invalid = micro_wakeword_create_from_buffer(t->config, t->garbage, t->garbage_size);
+	t->mww = micro_wakeword_create(t->config);
+	return NULL;
+}
+
+// Test creating detectors for one model from many threads at once, while
+// other threads fail to load an invalid model
+static int test_concurrent_create(void) {
+	printf("Running test_concurrent_create...\n");
+
+	const char *model_path = find_model_file("okay_nabu");
+	if (!model_path) {
+		printf("  SKIPPED: Model file not found\n");
+		return 0;
+	}
+
+	MicroWakeWordConfig config = {
+		.model_path = model_path,
+		.libtensorflowlite_c = find_tflite_lib(),
+		.probability_cutoff = 0.97f,
+		.sliding_window_size = 5
+	};
+
+	enum { NUM_THREADS = 8, NUM_FRAMES = 30 };
+	static const uint8_t garbage[256] = {0};
+	CreateThread threads[NUM_THREADS];
+	pthread_t ids[NUM_THREADS];
+	size_t started = 0;
+	int failed = 0;
+
+	for (; started < NUM_THREADS; ++started) {
+		threads[started] = (CreateThread){ .config = &config, .garbage = garbage,
+						   .garbage_size = sizeof(garbage) };
+		if (pthread_create(&ids[started], NULL, create_thread, &threads[started]) != 0) {
+			fprintf(stderr, "Failed to start creation thread\n");
+			failed = 1;
+			break;
+		}
+	}
+	for (size_t t = 0; t < started; ++t) {
+		pthread_join(ids[t], NULL);
+		if (!threads[t].mww || threads[t].invalid) {
+			fprintf(stderr, "Unexpected creation result in thread %zu\n", t);
+			failed = 1;
+		}
+	}
+
+	// Every detector runs the same model
+	float frame[FEATURES_PER_WINDOW];
+	float probs[NUM_THREADS];
+	for (size_t n = 0; !failed && n < NUM_FRAMES; ++n) {
+		for (size_t i = 0; i < FEATURES_PER_WINDOW; ++i) {
+			frame[i] = (float)((n * 3 + i * 7) % 26);
+		}
+		for (size_t t = 0; t < NUM_THREADS; ++t) {
+			micro_wakeword_process_streaming(threads[t].mww, frame, FEATURES_PER_WINDOW);
+			micro_wakeword_get_probabilities(threads[t].mww, &probs[t], NULL);
+			if (probs[t] != probs[0]) {
+				fprintf(stderr, "Detector %zu differs at frame %zu\n", t, n);
+				failed = 1;
+			}
+		}
+	}
+
+	for (size_t t = 0; t < started; ++t) {
+		micro_wakeword_destroy(threads[t].mww);
+		micro_wakeword_destroy(threads[t].invalid);
+	}
+
+	if (failed) {
+		return 1;
+	}
+
+	printf("  test_concurrent_create: PASSED\n");
+	return 0;
+}
+
+// Test reset functionality
+static int test_reset(void) {
+	printf("Running test_reset...\n");
+
+	const char *model_path = find_model_file("okay_nabu");
+	if (!model_path) {
+		printf("  SKIPPED: Model file not found\n");
+		return 0;
+	}
+
+	const char *lib_path = find_tflite_lib();
+
+	MicroWakeWordConfig config = {
+		.model_path = model_path,
+		.libtensorflowlite_c = lib_path,
+		.probability_cutoff = 0.97f,
+		.sliding_window_size = 5
+	};
+
+	MicroWakeWord *mww = micro_wakeword_create(&config);
+	if (!mww) {
+		fprintf(stderr, "Failed to create wake word detector\n");
+		return 1;
+	}
+
+	MicroWakeWordFeatures *features = micro_wakeword_features_create();
+	if (!features) {
+		micro_wakeword_destroy(mww);
+		return 1;
+	}
+
+	// Process some dummy audio
+	uint8_t dummy_audio[320] = {0};
+	float *feature_array = NULL;
+	size_t feature_count = 0;
+
+	micro_wakeword_features_process_streaming(features, dummy_audio,
+						  sizeof(dummy_audio),
+						  &feature_array, &feature_count);
+	if (feature_array) {
+		free(feature_array);
+	}
+
+	// Reset
+	micro_wakeword_reset(mww);
+	micro_wakeword_features_reset(features);
+
+	micro_wakeword_destroy(mww);
+	micro_wakeword_features_destroy(features);
+
+	printf("  test_reset: PASSED\n");
+	return 0;
+}
+
+// Test that reset restores the detector to its initial streaming state
+static int test_reset_restores_state(void) {
+	printf("Running test_reset_restores_state...\n");
+
+	const char *model_path = find_model_file("okay_nabu");
+	if (!model_path) {
+		printf("  SKIPPED: Model file not found\n");
+		return 0;
+	}
+
+	const char *lib_path = find_tflite_lib();
+
+	MicroWakeWordConfig config = {
+		.model_path = model_path,
+		.libtensorflowlite_c = lib_path,
+		.probability_cutoff = 0.97f,
+		.sliding_window_size = 5
+	};
+
+	MicroWakeWord *mww = micro_wakeword_create(&config);
+	if (!mww) {
+		fprintf(stderr, "Failed to create wake word detector\n");
+		return 1;
+	}
+
+	// Run the same frames before and after a reset and compare probabilities
+	enum { NUM_FRAMES = 60 };
+	float first[NUM_FRAMES];
+	float second[NUM_FRAMES];
+	float frame[FEATURES_PER_WINDOW];
+
+	for (int pass = 0; pass < 2; ++pass) {
+		float *probs = (pass == 0) ? first : second;
+		for (size_t n = 0; n < NUM_FRAMES; ++n) {
+			for (size_t i = 0; i < FEATURES_PER_WINDOW; ++i) {
+				frame[i] = (float)((n * 7 + i * 3) % 26);
+			}
+			micro_wakeword_process_streaming(mww, frame, FEATURES_PER_WINDOW);
+			micro_wakeword_get_probabilities(mww, &probs[n], NULL);
+		}
+		micro_wakeword_reset(mww);
+	}
+
+	micro_wakeword_destroy(mww);
+
+	if (memcmp(first, second, sizeof(first)) != 0) {
+		fprintf(stderr, "Probabilities differ after reset\n");
+		return 1;
+	}
+
+	printf("  test_reset_restores_state: PASSED\n");
+	return 0;
+}
+
+// Run NUM_OPTION_FRAMES frames through a detector, recording the latest
+// probability after each, then reset it
+enum { NUM_OPTION_FRAMES = 60 };
+static void run_option_frames(MicroWakeWord *mww, float *probs) {
+	float frame[FEATURES_PER_WINDOW];
+	for (size_t n = 0; n < NUM_OPTION_FRAMES; ++n) {
+		for (size_t i = 0; i < FEATURES_PER_WINDOW; ++i) {
+			frame[i] = (float)((n * 7 + i * 3) % 26);
+		}
+		micro_wakeword_process_streaming(mww, frame, FEATURES_PER_WINDOW);
+		micro_wakeword_get_probabilities(mww, &probs[n], NULL);
+	}
+	micro_wakeword_reset(mww);
+}
+
+// Test interpreter thread count and XNNPACK delegate options
+static int test_interpreter_options(void) {
+	printf("Running test_interpreter_options...\n");
+
+	const char *model_path = find_model_file("okay_nabu");
+	if (!model_path) {
+		printf("  SKIPPED: Model file not found\n");
+		return 0;
+	}
+
+	MicroWakeWordConfig config = {
+		.model_path = model_path,
+		.libtensorflowlite_c = find_tflite_lib(),
+		.probability_cutoff = 0.97f,
+		.sliding_window_size = 5
+	};
+	MicroWakeWordConfig threaded_config = config;
+	threaded_config.num_threads = 2;
+	MicroWakeWordConfig xnnpack_config = config;
+	xnnpack_config.use_xnnpack = true;
+	xnnpack_config.num_threads = 1;
+
+	MicroWakeWord *reference = micro_wakeword_create(&config);
+	MicroWakeWord *threaded = micro_wakeword_create(&threaded_config);
+	MicroWakeWord *xnnpack = micro_wakeword_create(&xnnpack_config);
+	if (!reference || !threaded || !xnnpack) {
+		fprintf(stderr, "Failed to create wake word detectors\n");
+		micro_wakeword_destroy(reference);
+		micro_wakeword_destroy(threaded);
+		micro_wakeword_destroy(xnnpack);
+		return 1;
+	}
+
+	float expected[NUM_OPTION_FRAMES];
+	float threaded_probs[NUM_OPTION_FRAMES];
+	float xnnpack_probs[NUM_OPTION_FRAMES];
+	float xnnpack_after_reset[NUM_OPTION_FRAMES];
+	run_option_frames(reference, expected);
+	run_option_frames(threaded, threaded_probs);
+	run_option_frames(xnnpack, xnnpack_probs);
+	run_option_frames(xnnpack, xnnpack_after_reset);
+
+	float output_scale;
+	micro_wakeword_get_quantization_params(reference, NULL, NULL, &output_scale, NULL);
+	bool uses_xnnpack = micro_wakeword_uses_xnnpack(xnnpack);
+	int failed = 0;
+
+	if (micro_wakeword_uses_xnnpack(reference) || micro_wakeword_uses_xnnpack(threaded)) {
+		fprintf(stderr, "XNNPACK active without being requested\n");
+		failed = 1;
+	}
+	if (memcmp(expected, threaded_probs, sizeof(expected)) != 0) {
+		fprintf(stderr, "Probabilities differ with num_threads = 2\n");
+		failed = 1;
+	}
+
+	// The delegate's kernels may round differently, by one output step at most
+	for (size_t n = 0; n < NUM_OPTION_FRAMES; ++n) {
+		if (fabsf(xnnpack_probs[n] - expected[n]) > output_scale * 1.01f) {
+			fprintf(stderr, "XNNPACK probability %zu: expected %f, got %f\n", n,
+				expected[n], xnnpack_probs[n]);
+			failed = 1;
+			break;
+		}
+	}
+	if (memcmp(xnnpack_probs, xnnpack_after_reset, sizeof(xnnpack_probs)) != 0 ||
+	    micro_wakeword_uses_xnnpack(xnnpack) != uses_xnnpack) {
+		fprintf(stderr, "XNNPACK detector changed after reset\n");
+		failed = 1;
+	}
+
+	micro_wakeword_destroy(reference);
+	micro_wakeword_destroy(threaded);
+	micro_wakeword_destroy(xnnpack);
+
+	if (failed) {
+		return 1;
+	}
+
+	printf("  test_interpreter_options: PASSED (XNNPACK %s)\n",
+	       uses_xnnpack ? "active" : "unavailable");
+	return 0;
+}
+
+// Test that steady-state detector processing does not touch the heap
+static int test_no_alloc_streaming(void) {
+	printf("Running test_no_alloc_streaming...\n");
+
+	const char *model_path = find_model_file("okay_nabu");
+	if (!model_path) {
+		printf("  SKIPPED: Model file not found\n");
+		return 0;
+	}
+
+	const char *lib_path = find_tflite_lib();
+
+	MicroWakeWordConfig config = {
+		.model_path = model_path,
+		.libtensorflowlite_c = lib_path,
+		.probability_cutoff = 0.97f,
+		.sliding_window_size = 5
+	};
+
+	MicroWakeWord *mww = micro_wakeword_create(&config);
+	if (!mww) {
+		fprintf(stderr, "Failed to create wake word detector\n");
+		return 1;
+	}
+
+	float frame[FEATURES_PER_WINDOW];
+	for (size_t i = 0; i < FEATURES_PER_WINDOW; ++i) {
+		frame[i] = (float)i * 0.5f;
+	}
+
+	size_t before = alloc_count;
+	for (size_t i = 0; i < 300; ++i) {
+		micro_wakeword_process_streaming(mww, frame, FEATURES_PER_WINDOW);
+	}
+	size_t allocs = alloc_count - before;
+
+	micro_wakeword_destroy(mww);
+
+	if (allocs != 0) {
+		fprintf(stderr, "Expected no heap allocations, got %zu\n", allocs);
+		return 1;
+	}
+
+	printf("  test_no_alloc_streaming: PASSED\n");
+	return 0;
+}
+
+// Test that every SIMD quantizer this CPU supports is bit-exact with the
+// scalar reference, including values right next to rounding ties
+static int test_quantize_kernels(void) {
+	printf("Running test_quantize_kernels...\n");
+
+	const struct {
+		float scale;
+		int32_t zero_point;
+	} params_list[] = {
+		{ 0.1015625f, -128 },  // Exact binary scale
+		{ 0.0973f, -128 },     // Reciprocal is inexact
+		{ 0.3f, 5 },
+		{ 0.0017f, 0 },
+	};
+
+	size_t capacity = 8192;
+	float *src = (float *)malloc((capacity + 1) * sizeof(float));
+	uint8_t *expected = (uint8_t *)malloc(capacity);
+	uint8_t *actual = (uint8_t *)malloc(capacity);
+	if (!src || !expected || !actual) {
+		free(src);
+		free(expected);
+		free(actual);
+		return 1;
+	}
+
+	QuantizeFunc funcs[8];
+	const char *names[8];
+	size_t num_kernels = quantize_available_kernels(funcs, names, 8);
+	QuantizeFunc frame_funcs[8];
+	const char *frame_names[8];
+	size_t num_frame_kernels = quantize_available_frame_kernels(frame_funcs, frame_names, 8);
+	int failed = 0;
+
+	for (size_t p = 0; p < sizeof(params_list) / sizeof(params_list[0]); ++p) {
+		QuantizeParams params;
+		quantize_params_init(&params, params_list[p].scale, params_list[p].zero_point);
+
+		// Ties and their neighbours, then pseudo-random values of all magnitudes
+		size_t n = 0;
+		for (int k = -400; k < 400 && n + 3 <= capacity; ++k) {
+			float tie = ((float)k + 0.5f - (float)params.zero_point) * params.scale;
+			src[1 + n++] = tie;
+			src[1 + n++] = nextafterf(tie, INFINITY);
+			src[1 + n++] = nextafterf(tie, -INFINITY);
+		}
+		uint32_t seed = 42;
+		while (n < capacity - 3) {
+			seed = seed * 1103515245u + 12345u;
+			float unit = (float)(seed >> 8) / 16777216.0f - 0.5f;
+			float magnitude = (seed & 3) == 0 ? 1e4f : (seed & 3) == 1 ? 30.0f : 0.01f;
+			src[1 + n++] = unit * magnitude;
+		}
+
+		// Misaligned source and an odd length exercise the tails
+		quantize_scalar(src + 1, expected, n, &params);
+		for (size_t k = 0; k < num_kernels; ++k) {
+			memset(actual, 0, n);
+			funcs[k](src + 1, actual, n, &params);
+			for (size_t i = 0; i < n; ++i) {
+				if (actual[i] != expected[i]) {
+					fprintf(stderr, "%s: value %.9g (scale %g) gave %u, expected %u\n",
+						names[k], src[1 + i], params.scale, actual[i], expected[i]);
+					failed = 1;
+					break;
+				}
+			}
+		}
+
+		// Fixed-width kernels, one frame at a time
+		size_t frames = n / QUANTIZE_FRAME_SIZE;
+		for (size_t k = 0; k < num_frame_kernels; ++k) {
+			memset(actual, 0, n);
+			for (size_t f = 0; f < frames; ++f) {
+				frame_funcs[k](src + 1 + f * QUANTIZE_FRAME_SIZE,
+					       actual + f * QUANTIZE_FRAME_SIZE, QUANTIZE_FRAME_SIZE, &params);
+			}
+			if (memcmp(actual, expected, frames * QUANTIZE_FRAME_SIZE) != 0) {
+				fprintf(stderr, "%s (frame): differs from the scalar kernel (scale %g)\n",
+					frame_names[k], params.scale);
+				failed = 1;
+			}
+		}
+	}
+
+	free(src);
+	free(expected);
+	free(actual);
+
+	if (failed) {
+		return 1;
+	}
+
+	printf("  test_quantize_kernels: PASSED (%s)\n", quantize_kernel_name());
+	return 0;
+}
+
+// Test that the running mean tracks a fresh float re-summation of the
+// window (the previous implementation) within the documented tolerance
+static int test_probability_window(void) {
+	printf("Running test_probability_window...\n");
+
+	const size_t sizes[] = { 1, 5, 50, 1000 };
+	int failed = 0;
+
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]) && !failed; ++s) {
+		ProbabilityWindow window;
+		if (probability_window_init(&window, sizes[s]) != 0) {
+			return 1;
+		}
+
+		uint32_t seed = 7;
+		for (size_t n = 0; n < 100000 && !failed; ++n) {
+			// Dequantized uint8 outputs, mostly near 0 with bursts near 1
+			seed = seed * 1103515245u + 12345u;
+			uint32_t q = (seed >> 16) & 0xff;
+			float prob = (float)((n / 997) % 2 ? q : q / 16) * (1.0f / 256.0f);
+			probability_window_add(&window, prob);
+
+			float sum = 0.0f;
+			float max = 0.0f;
+			for (size_t i = 0; i < window.count; ++i) {
+				sum += window.probabilities[i];
+				max = fmaxf(max, window.probabilities[i]);
+			}
+			float expected = sum / window.count;
+			float mean = probability_window_mean(&window);
+			if (fabsf(mean - expected) > PROBABILITY_WINDOW_TOLERANCE ||
+			    probability_window_latest(&window) != prob ||
+			    probability_window_max(&window) != max) {
+				fprintf(stderr, "Window %zu after %zu adds: mean %.9g, expected %.9g\n",
+					sizes[s], n + 1, mean, expected);
+				failed = 1;
+			}
+		}
+
+		probability_window_clear(&window);
+		if (!failed && probability_window_max(&window) != 0.0f) {
+			fprintf(stderr, "Window %zu: max not cleared\n", sizes[s]);
+			failed = 1;
+		}
+		probability_window_free(&window);
+	}
+
+	if (failed) {
+		return 1;
+	}
+
+	printf("  test_probability_window: PASSED\n");
+	return 0;
+}
+
+// Deterministic pseudo-random PCM (caller frees)
+static int16_t *make_noise(size_t num_samples) {
+	int16_t *samples = (int16_t *)malloc(num_samples * sizeof(int16_t));
+	if (!samples) {
+		return NULL;
+	}
+	uint32_t seed = 12345;
+	for (size_t i = 0; i < num_samples; ++i) {
+		seed = seed * 1103515245u + 12345u;
+		samples[i] = (int16_t)((seed >> 16) & 0x3fff) - 0x2000;
+	}
+	return samples;
+}
+
+// Test that writing features into a caller-owned buffer matches the
+// allocating API, with leftover audio kept buffered between calls
+static int test_features_into(void) {
+	printf("Running test_features_into...\n");
+
+	size_t num_samples = 16000;
+	int16_t *samples = make_noise(num_samples);
+	if (!samples) {
+		return 1;
+	}
+	const uint8_t *audio = (const uint8_t *)samples;
+	size_t audio_size = num_samples * sizeof(int16_t);
+
+	MicroWakeWordFeatures *reference = micro_wakeword_features_create();
+	MicroWakeWordFeatures *features = micro_wakeword_features_create();
+	float *expected = NULL;
+	size_t expected_size = 0;
+	if (!reference || !features ||
+	    micro_wakeword_features_process_streaming(reference, audio, audio_size,
+						      &expected, &expected_size) != 0) {
+		fprintf(stderr, "Failed to generate reference features\n");
+		free(expected);
+		micro_wakeword_features_destroy(reference);
+		micro_wakeword_features_destroy(features);
+		free(samples);
+		return 1;
+	}
+
+	// Odd packet sizes (so every other packet is misaligned) and a buffer
+	// too small to hold a whole packet, draining the backlog in between
+	float out[3 * MICRO_WAKEWORD_FEATURES_PER_FRAME];
+	size_t written = 0;
+	bool mismatch = false;
+	for (size_t offset = 0; offset < audio_size && !mismatch;) {
+		size_t size = audio_size - offset < 1233 ? audio_size - offset : 1233;
+		const uint8_t *packet = audio + offset;
+		offset += size;
+
+		int frames;
+		do {
+			frames = micro_wakeword_features_process_streaming_into(
+				features, packet, size, out, 3);
+			packet = NULL;
+			size = 0;
+			if (frames < 0) {
+				mismatch = true;
+				break;
+			}
+
+			size_t floats = (size_t)frames * MICRO_WAKEWORD_FEATURES_PER_FRAME;
+			if (written + floats > expected_size ||
+			    memcmp(out, expected + written, floats * sizeof(float)) != 0) {
+				mismatch = true;
+			}
+			written += floats;
+		} while (frames == 3 && !mismatch);
+	}
+
+	// A backlog that would outgrow its bound is rejected
+	if (micro_wakeword_features_process_streaming_into(
+		    features, audio, MICRO_WAKEWORD_FEATURES_BACKLOG_BYTES + 2, out, 0) >= 0) {
+		fprintf(stderr, "Expected oversized backlog to be rejected\n");
+		mismatch = true;
+	}
+
+	free(expected);
+	micro_wakeword_features_destroy(reference);
+	micro_wakeword_features_destroy(features);
+	free(samples);
+
+	if (mismatch || written != expected_size) {
+		fprintf(stderr, "Features differ from reference (%zu of %zu floats)\n",
+			written, expected_size);
+		return 1;
+	}
+
+	printf("  test_features_into: PASSED\n");
+	return 0;
+}
+
+// Frames received by collect_frame
+typedef struct {
+	const float *expected;
+	size_t expected_size;
+	size_t written;
+	uint64_t last_end_sample;
+	size_t stop_after;  // Frames to accept before failing (SIZE_MAX for all)
+	bool mismatch;
+} FrameCollector;
+
+static int collect_frame(void *user_data, const float *frame, uint64_t end_sample) {
+	FrameCollector *collector = (FrameCollector *)user_data;
+	if (collector->stop_after-- == 0) {
+		return -7;
+	}
+
+	size_t floats = MICRO_WAKEWORD_FEATURES_PER_FRAME;
+	if (collector->written + floats > collector->expected_size ||
+	    memcmp(frame, collector->expected + collector->written, floats * sizeof(float)) != 0 ||
+	    end_sample <= collector->last_end_sample) {
+		collector->mismatch = true;
+	}
+	collector->written += floats;
+	collector->last_end_sample = end_sample;
+	return 0;
+}
+
+// Test that the callback API hands over the same frames as the copying one,
+// and stops with the callback's error
+static int test_features_callback(void) {
+	printf("Running test_features_callback...\n");
+
+	size_t num_samples = 16000;
+	int16_t *samples = make_noise(num_samples);
+	if (!samples) {
+		return 1;
+	}
+	const uint8_t *audio = (const uint8_t *)samples;
+	size_t audio_size = num_samples * sizeof(int16_t);
+
+	MicroWakeWordFeatures *reference = micro_wakeword_features_create();
+	MicroWakeWordFeatures *features = micro_wakeword_features_create();
+	float *expected = NULL;
+	size_t expected_size = 0;
+	if (!reference || !features ||
+	    micro_wakeword_features_process_streaming(reference, audio, audio_size,
+						      &expected, &expected_size) != 0) {
+		fprintf(stderr, "Failed to generate reference features\n");
+		free(expected);
+		micro_wakeword_features_destroy(reference);
+		micro_wakeword_features_destroy(features);
+		free(samples);
+		return 1;
+	}
+
+	FrameCollector collector = { expected, expected_size, 0, 0, SIZE_MAX, false };
+	size_t frames = 0;
+	for (size_t offset = 0; offset < audio_size && !collector.mismatch;) {
+		size_t size = audio_size - offset < 1233 ? audio_size - offset : 1233;
+		int result = micro_wakeword_features_process_streaming_callback(
+			features, audio + offset, size, collect_frame, &collector);
+		offset += size;
+		if (result < 0) {
+			collector.mismatch = true;
+			break;
+		}
+		frames += (size_t)result;
+	}
+
+	// The callback's error ends the call
+	micro_wakeword_features_reset(features);
+	FrameCollector stopping = { expected, expected_size, 0, 0, 2, false };
+	int stopped = micro_wakeword_features_process_streaming_callback(
+		features, audio, 10 * 320, collect_frame, &stopping);
+
+	free(expected);
+	micro_wakeword_features_destroy(reference);
+	micro_wakeword_features_destroy(features);
+	free(samples);
+
+	if (collector.mismatch || collector.written != expected_size ||
+	    frames * MICRO_WAKEWORD_FEATURES_PER_FRAME != expected_size) {
+		fprintf(stderr, "Features differ from reference (%zu of %zu floats)\n",
+			collector.written, expected_size);
+		return 1;
+	}
+	if (stopped != -7 || stopping.written != 2 * MICRO_WAKEWORD_FEATURES_PER_FRAME) {
+		fprintf(stderr, "Expected the callback error to stop processing (got %d)\n", stopped);
+		return 1;
+	}
+
+	printf("  test_features_callback: PASSED\n");
+	return 0;
+}
+
+// Test that per-frame results carry sample positions, probabilities and the
+// model id, and that errors are reported as distinct codes
+static int test_process_frame_results(void) {
+	printf("Running test_process_frame_results...\n");
+
+	const char *model_path = find_model_file("okay_nabu");
+	if (!model_path) {
+		printf("  SKIPPED: Model file not found\n");
+		return 0;
+	}
+
+	// A negative cutoff makes every full window a detection
+	MicroWakeWordConfig config = {
+		.model_path = model_path,
+		.libtensorflowlite_c = find_tflite_lib(),
+		.probability_cutoff = -1.0f,
+		.sliding_window_size = 3,
+		.model_id = 7
+	};
+
+	MicroWakeWord *mww = micro_wakeword_create(&config);
+	MicroWakeWordFeatures *features = micro_wakeword_features_create();
+	size_t num_samples = 8000;
+	int16_t *samples = make_noise(num_samples);
+	if (!mww || !features || !samples) {
+		fprintf(stderr, "Failed to set up test\n");
+		micro_wakeword_destroy(mww);
+		micro_wakeword_features_destroy(features);
+		free(samples);
+		return 1;
+	}
+
+	int failed = 0;
+	MicroWakeWordResult result;
+	float frame[FEATURES_PER_WINDOW];
+
+	// Errors leave the position alone
+	if (micro_wakeword_process_frame(NULL, frame, FEATURES_PER_WINDOW, &result) != -1 ||
+	    micro_wakeword_process_frame(mww, frame, FEATURES_PER_WINDOW - 1, &result) != -2 ||
+	    micro_wakeword_get_sample_position(mww) != 0) {
+		fprintf(stderr, "Expected distinct error codes for bad arguments\n");
+		failed = 1;
+	}
+
+	size_t inferences = 0;
+	for (size_t n = 0; !failed && n < 30; ++n) {
+		for (size_t i = 0; i < FEATURES_PER_WINDOW; ++i) {
+			frame[i] = (float)((n * 7 + i * 3) % 26);
+		}
+		int status = micro_wakeword_process_frame(mww, frame, FEATURES_PER_WINDOW, &result);
+
+		float latest, mean;
+		size_t count = micro_wakeword_get_probabilities(mww, &latest, &mean);
+		inferences += result.inferences;
+		if (status < 0 || result.sample_offset != (n + 1) * 160 ||
+		    result.sample_offset != micro_wakeword_get_sample_position(mww) ||
+		    result.model_id != 7 || result.probability != latest ||
+		    result.mean_probability != mean || result.peak_probability < latest ||
+		    result.peak_probability < mean || result.inferences > 1 ||
+		    result.detected != (status == 1) ||
+		    result.detected != (result.inferences == 1 && count >= 3)) {
+			fprintf(stderr, "Unexpected result for frame %zu (status %d)\n", n, status);
+			failed = 1;
+		}
+	}
+	// The bundled models take 3 frames per inference
+	if (!failed && inferences != 30 / 3) {
+		fprintf(stderr, "Expected 10 inferences, got %zu\n", inferences);
+		failed = 1;
+	}
+
+	// Through the feature generator, positions follow the audio
+	micro_wakeword_reset(mww);
+	if (!failed && micro_wakeword_get_sample_position(mww) != 0) {
+		fprintf(stderr, "Reset did not clear the sample position\n");
+		failed = 1;
+	}
+	MicroWakeWordDetection detections[64];
+	int count = micro_wakeword_process_audio(mww, features, (const uint8_t *)samples,
+						 num_samples * sizeof(int16_t), detections, 64);
+	if (!failed && (count <= 0 || count > 64 ||
+			micro_wakeword_get_sample_position(mww) !=
+			micro_wakeword_features_get_sample_position(features))) {
+		fprintf(stderr, "Detector and features disagree on the sample position\n");
+		failed = 1;
+	}
+	for (int i = 0; !failed && i < count; ++i) {
+		if (detections[i].model_id != 7 ||
+		    detections[i].peak_probability < detections[i].probability ||
+		    detections[i].sample_offset % 160 != 0 ||
+		    (i > 0 && detections[i].sample_offset <= detections[i - 1].sample_offset)) {
+			fprintf(stderr, "Unexpected detection %d\n", i);
+			failed = 1;
+		}
+	}
+
+	micro_wakeword_destroy(mww);
+	micro_wakeword_features_destroy(features);
+	free(samples);
+
+	if (failed) {
+		return 1;
+	}
+
+	printf("  test_process_frame_results: PASSED\n");
+	return 0;
+}
+
+#define REFRACTORY_FRAMES 450
+
+// Frames that make hey_mycroft's output swing between 1/256 and 2/256
+static void refractory_frame(size_t n, float *frame) {
+	for (size_t i = 0; i < FEATURES_PER_WINDOW; ++i) {
+		frame[i] = (float)((n * 4 + i * 10) % 20 + ((n / 15) % 2 ? 8 : 0));
+	}
+}
+
+// Detections expected from the refractory and re-arm rules, given the mean
+// probability and end sample of every inference (one per entry)
+static size_t expected_detections(const float *means, const uint64_t *positions,
+				  size_t count, const MicroWakeWordConfig *config,
+				  bool *detected, size_t *suppressed) {
+	bool armed = true;
+	uint64_t end_sample = 0;
+	size_t end_step = 0;
+	size_t detections = 0;
+	*suppressed = 0;
+
+	for (size_t i = 0; i < count; ++i) {
+		detected[i] = false;
+		if (!armed && means[i] <= config->rearm_cutoff) {
+			armed = true;
+		}
+		if (means[i] <= config->probability_cutoff) {
+			continue;
+		}
+		if (!armed || positions[i] < end_sample || i + 1 < end_step) {
+			(*suppressed)++;
+			continue;
+		}
+		detected[i] = true;
+		detections++;
+		end_sample = positions[i] + (uint64_t)config->refractory_ms * 16;
+		end_step = i + 1 + config->refractory_steps;
+		armed = !(config->rearm_cutoff > 0.0f);
+	}
+	return detections;
+}
+
+// Test that refractory periods and re-arm hysteresis hold back repeated
+// detections while inference keeps running
+static int test_refractory(void) {
+	printf("Running test_refractory...\n");
+
+	const char *model_path = find_model_file("hey_mycroft");
+	if (!model_path) {
+		printf("  SKIPPED: Model file not found\n");
+		return 0;
+	}
+
+	MicroWakeWordConfig base = {
+		.model_path = model_path,
+		.libtensorflowlite_c = find_tflite_lib(),
+		.probability_cutoff = 1.5f / 256.0f,
+		.sliding_window_size = 1
+	};
+
+	// The re-arm level must lie below the cutoff
+	MicroWakeWordConfig bad = base;
+	bad.rearm_cutoff = base.probability_cutoff;
+	MicroWakeWord *mww = micro_wakeword_create(&bad);
+	bad.rearm_cutoff = -0.1f;
+	MicroWakeWord *mww_negative = micro_wakeword_create(&bad);
+	if (mww || mww_negative) {
+		fprintf(stderr, "Invalid rearm_cutoff was accepted\n");
+		micro_wakeword_destroy(mww);
+		micro_wakeword_destroy(mww_negative);
+		return 1;
+	}
+
+	// Record the mean and position of every inference
+	float means[REFRACTORY_FRAMES];
+	uint64_t positions[REFRACTORY_FRAMES];
+	size_t inferences = 0;
+	float frame[FEATURES_PER_WINDOW];
+	MicroWakeWordResult result;
+	mww = micro_wakeword_create(&base);
+	if (!mww) {
+		fprintf(stderr, "Failed to create detector\n");
+		return 1;
+	}
+	for (size_t n = 0; n < REFRACTORY_FRAMES; ++n) {
+		refractory_frame(n, frame);
+		if (micro_wakeword_process_frame(mww, frame, FEATURES_PER_WINDOW, &result) < 0) {
+			fprintf(stderr, "Failed to process frame %zu\n", n);
+			micro_wakeword_destroy(mww);
+			return 1;
+		}
+		if (result.inferences == 1) {
+			means[inferences] = result.mean_probability;
+			positions[inferences] = result.sample_offset;
+			inferences++;
+		}
+	}
+	micro_wakeword_destroy(mww);
+
+	MicroWakeWordConfig configs[5];
+	for (size_t c = 0; c < 5; ++c) {
+		configs[c] = base;
+	}
+	configs[1].refractory_steps = 4;
+	configs[2].refractory_ms = 100;
+	configs[3].rearm_cutoff = 1.2f / 256.0f;
+	configs[4].rearm_cutoff = 1.2f / 256.0f;
+	configs[4].refractory_ms = 250;
+
+	int failed = 0;
+	bool expected[REFRACTORY_FRAMES];
+	size_t plain = 0;
+	for (size_t c = 0; !failed && c < 5; ++c) {
+		size_t suppressed;
+		size_t detections = expected_detections(means, positions, inferences, &configs[c],
+							expected, &suppressed);
+		if (c == 0) {
+			plain = detections;
+		}
+		// Each setting must hold back some but not all detections
+		if (detections == 0 || (c > 0 && detections >= plain)) {
+			fprintf(stderr, "Config %zu: %zu of %zu detections, model output changed?\n",
+				c, detections, plain);
+			failed = 1;
+			break;
+		}
+
+		mww = micro_wakeword_create(&configs[c]);
+		if (!mww) {
+			fprintf(stderr, "Failed to create detector for config %zu\n", c);
+			failed = 1;
+			break;
+		}
+		micro_wakeword_enable_stats(mww, true);
+
+		// Twice, as reset must re-arm the detector
+		for (size_t pass = 0; !failed && pass < 2; ++pass) {
+			size_t inference = 0;
+			for (size_t n = 0; n < REFRACTORY_FRAMES; ++n) {
+				refractory_frame(n, frame);
+				int status = micro_wakeword_process_frame(mww, frame, FEATURES_PER_WINDOW,
+									  &result);
+				if (result.inferences != 1) {
+					continue;
+				}
+				if (status != (expected[inference] ? 1 : 0)) {
+					fprintf(stderr, "Config %zu pass %zu: inference %zu returned %d\n",
+						c, pass, inference, status);
+					failed = 1;
+					break;
+				}
+				inference++;
+			}
+
+			MicroWakeWordStats stats;
+			micro_wakeword_get_stats(mww, &stats);
+			if (!failed && (stats.inferences != inferences ||
+					stats.detections != detections || stats.suppressed != suppressed)) {
+				fprintf(stderr, "Config %zu: %llu detections, %llu suppressed\n", c,
+					(unsigned long long)stats.detections,
+					(unsigned long long)stats.suppressed);
+				failed = 1;
+			}
+			micro_wakeword_reset(mww);
+			micro_wakeword_enable_stats(mww, false);
+			micro_wakeword_enable_stats(mww, true);
+		}
+		micro_wakeword_destroy(mww);
+	}
+
+	if (failed) {
+		return 1;
+	}
+
+	printf("  test_refractory: PASSED\n");
+	return 0;
+}
+
+// Test that the fused audio API reports the same detections as feeding
+// frames by hand, with the sample offset of each triggering frame
+static int test_process_audio(void) {
+	printf("Running test_process_audio...\n");
+
+	const char *model_path = find_model_file("okay_nabu");
+	if (!model_path) {
+		printf("  SKIPPED: Model file not found\n");
+		return 0;
+	}
+
+	// A negative cutoff makes every inference a detection
+	MicroWakeWordConfig config = {
+		.model_path = model_path,
+		.libtensorflowlite_c = find_tflite_lib(),
+		.probability_cutoff = -1.0f,
+		.sliding_window_size = 1
+	};
+
+	size_t num_samples = 16000;
+	int16_t *samples = make_noise(num_samples);
+	MicroWakeWord *reference = micro_wakeword_create(&config);
+	MicroWakeWord *mww = micro_wakeword_create(&config);
+	MicroWakeWordFeatures *reference_features = micro_wakeword_features_create();
+	MicroWakeWordFeatures *features = micro_wakeword_features_create();
+	float *feature_array = NULL;
+	size_t feature_count = 0;
+	int failed = 0;
+
+	const uint8_t *audio = (const uint8_t *)samples;
+	size_t audio_size = num_samples * sizeof(int16_t);
+	if (!samples || !reference || !mww || !reference_features || !features ||
+	    micro_wakeword_features_process_streaming(reference_features, audio, audio_size,
+						      &feature_array, &feature_count) != 0) {
+		fprintf(stderr, "Failed to set up test\n");
+		failed = 1;
+	}
+
+	// Expected offsets: end of each frame that triggered
+	uint64_t expected[100];
+	size_t num_expected = 0;
+	for (size_t i = 0; !failed && i + FEATURES_PER_WINDOW <= feature_count;
+	     i += FEATURES_PER_WINDOW) {
+		if (micro_wakeword_process_streaming(reference, &feature_array[i],
+						     FEATURES_PER_WINDOW) &&
+		    num_expected < 100) {
+			expected[num_expected++] = (i / FEATURES_PER_WINDOW + 1) * 160;
+		}
+	}
+
+	// Same audio in odd-sized packets
+	MicroWakeWordDetection detections[100];
+	size_t num_detections = 0;
+	for (size_t offset = 0; !failed && offset < audio_size; offset += 999) {
+		size_t size = audio_size - offset < 999 ? audio_size - offset : 999;
+		int result = micro_wakeword_process_audio(mww, features, audio + offset, size,
+							  detections + num_detections,
+							  100 - num_detections);
+		if (result < 0 || num_detections + (size_t)result > 100) {
+			failed = 1;
+			break;
+		}
+		num_detections += (size_t)result;
+	}
+
+	if (!failed && (num_expected == 0 || num_detections != num_expected)) {
+		fprintf(stderr, "Expected %zu detections, got %zu\n", num_expected, num_detections);
+		failed = 1;
+	}
+	for (size_t i = 0; !failed && i < num_detections; ++i) {
+		if (detections[i].sample_offset != expected[i]) {
+			fprintf(stderr, "Detection %zu at sample %llu, expected %llu\n", i,
+				(unsigned long long)detections[i].sample_offset,
+				(unsigned long long)expected[i]);
+			failed = 1;
+		}
+	}
+
+	free(feature_array);
+	micro_wakeword_features_destroy(reference_features);
+	micro_wakeword_features_destroy(features);
+	micro_wakeword_destroy(reference);
+	micro_wakeword_destroy(mww);
+	free(samples);
+
+	if (failed) {
+		return 1;
+	}
+
+	printf("  test_process_audio: PASSED\n");
+	return 0;
+}
+
+// Test that models sharing one feature generator report the same hits as
+// running each model with its own generator
+static int test_multi_model(void) {
+	printf("Running test_multi_model...\n");
+
+	const char *model_names[] = { "okay_nabu", "hey_jarvis", "alexa" };
+	const size_t num_models = 3;
+	MicroWakeWordConfig configs[3];
+	memset(configs, 0, sizeof(configs));
+	char model_paths[3][512];
+	for (size_t i = 0; i < num_models; ++i) {
+		const char *model_path = find_model_file(model_names[i]);
+		if (!model_path) {
+			printf("  SKIPPED: Model file not found\n");
+			return 0;
+		}
+		snprintf(model_paths[i], sizeof(model_paths[i]), "%s", model_path);
+
+		// A negative cutoff makes every inference a detection
+		configs[i].model_path = model_paths[i];
+		configs[i].libtensorflowlite_c = find_tflite_lib();
+		configs[i].probability_cutoff = -1.0f;
+		configs[i].sliding_window_size = i + 1;
+	}
+
+	size_t num_samples = 16000;
+	int16_t *samples = make_noise(num_samples);
+	MicroWakeWordMulti *multi = micro_wakeword_multi_create(configs, num_models);
+	if (!samples || !multi) {
+		fprintf(stderr, "Failed to create multi-model detector\n");
+		micro_wakeword_multi_destroy(multi);
+		free(samples);
+		return 1;
+	}
+
+	const uint8_t *audio = (const uint8_t *)samples;
+	size_t audio_size = num_samples * sizeof(int16_t);
+	int failed = 0;
+
+	// One call over all the audio
+	MicroWakeWordMultiResult result;
+	int total = micro_wakeword_multi_process_audio(multi, audio, audio_size, &result);
+	if (total <= 0 || result.num_models != num_models) {
+		fprintf(stderr, "Expected detections from every model, got %d\n", total);
+		failed = 1;
+	}
+
+	for (size_t i = 0; !failed && i < num_models; ++i) {
+		MicroWakeWord *mww = micro_wakeword_create(&configs[i]);
+		MicroWakeWordFeatures *features = micro_wakeword_features_create();
+		MicroWakeWordDetection first;
+		int expected = micro_wakeword_process_audio(mww, features, audio, audio_size,
+							    &first, 1);
+		if (expected <= 0 || result.detections[i] != (size_t)expected ||
+		    result.first[i].sample_offset != first.sample_offset) {
+			fprintf(stderr, "%s: expected %d detections, got %zu\n", model_names[i],
+				expected, result.detections[i]);
+			failed = 1;
+		}
+		micro_wakeword_features_destroy(features);
+		micro_wakeword_destroy(mww);
+	}
+
+	micro_wakeword_multi_destroy(multi);
+	free(samples);
+
+	if (failed) {
+		return 1;
+	}
+
+	printf("  test_multi_model: PASSED\n");
+	return 0;
+}
+
+// Invocations left before failing_invoke starts failing
+static size_t invoke_budget = 0;
+static TfLiteInterpreterInvokeFunc real_invoke = NULL;
+
+static TfLiteStatus failing_invoke(TfLiteInterpreter interpreter) {
+	if (invoke_budget == 0) {
+		return 1;
+	}
+	invoke_budget--;
+	return real_invoke(interpreter);
+}
+
+// Test that a model failing mid-stream does not desynchronize the others
+static int test_multi_model_error(void) {
+	printf("Running test_multi_model_error...\n");
+
+	const char *model_names[] = { "okay_nabu", "hey_jarvis", "alexa" };
+	const size_t num_models = 3;
+	const char *lib_path = find_tflite_lib();
+	char model_paths[3][512];
+	for (size_t i = 0; i < num_models; ++i) {
+		const char *model_path = find_model_file(model_names[i]);
+		if (!model_path || !lib_path) {
+			printf("  SKIPPED: Model file or TensorFlow Lite library not found\n");
+			return 0;
+		}
+		snprintf(model_paths[i], sizeof(model_paths[i]), "%s", model_path);
+	}
+
+	// The first model loads the library through another path, so it gets a
+	// runtime of its own whose invoke can be made to fail
+	char failing_lib[512];
+	snprintf(failing_lib, sizeof(failing_lib), "./%s", lib_path);
+	TfLiteRuntime *rt = tflite_runtime_acquire(failing_lib);
+	if (!rt) {
+		fprintf(stderr, "Failed to load TensorFlow Lite runtime\n");
+		return 1;
+	}
+
+	MicroWakeWordConfig configs[3];
+	memset(configs, 0, sizeof(configs));
+	for (size_t i = 0; i < num_models; ++i) {
+		configs[i].model_path = model_paths[i];
+		configs[i].libtensorflowlite_c = i == 0 ? failing_lib : lib_path;
+		configs[i].probability_cutoff = -1.0f;
+		configs[i].sliding_window_size = 2;
+	}
+
+	size_t num_samples = 16000;
+	int16_t *samples = make_noise(num_samples);
+	MicroWakeWordMulti *multi = micro_wakeword_multi_create(configs, num_models);
+	int failed = 0;
+	if (!samples || !multi) {
+		fprintf(stderr, "Failed to create multi-model detector\n");
+		failed = 1;
+	}
+
+	// The first model fails after 10 inferences
+	const uint8_t *audio = (const uint8_t *)samples;
+	size_t audio_size = num_samples * sizeof(int16_t);
+	MicroWakeWordMultiResult result;
+	real_invoke = rt->TfLiteInterpreterInvoke;
+	invoke_budget = 10;
+	rt->TfLiteInterpreterInvoke = failing_invoke;
+	if (!failed && micro_wakeword_multi_process_audio(multi, audio, audio_size, &result) >= 0) {
+		fprintf(stderr, "Expected the failing model's error\n");
+		failed = 1;
+	}
+	rt->TfLiteInterpreterInvoke = real_invoke;
+
+	// The other models saw every frame, like detectors of their own
+	for (size_t i = 1; !failed && i < num_models; ++i) {
+		MicroWakeWord *mww = micro_wakeword_create(&configs[i]);
+		MicroWakeWordFeatures *features = micro_wakeword_features_create();
+		MicroWakeWordDetection first;
+		int expected = micro_wakeword_process_audio(mww, features, audio, audio_size,
+							    &first, 1);
+		MicroWakeWord *shared = micro_wakeword_multi_get_detector(multi, i);
+		float probs[2][2];
+		size_t counts[2] = {
+			micro_wakeword_get_probabilities(mww, &probs[0][0], &probs[0][1]),
+			micro_wakeword_get_probabilities(shared, &probs[1][0], &probs[1][1])
+		};
+		if (expected <= 0 || result.detections[i] != (size_t)expected ||
+		    result.first[i].sample_offset != first.sample_offset ||
+		    counts[0] != counts[1] || memcmp(probs[0], probs[1], sizeof(probs[0])) != 0) {
+			fprintf(stderr, "%s fell out of step after another model failed\n",
+				model_names[i]);
+			failed = 1;
+		}
+		micro_wakeword_features_destroy(features);
+		micro_wakeword_destroy(mww);
+	}
+
+	micro_wakeword_multi_destroy(multi);
+	tflite_runtime_release(rt);
+	free(samples);
+
+	if (failed) {
+		return 1;
+	}
+
+	printf("  test_multi_model_error: PASSED\n");
+	return 0;
+}
+
+// Test the opt-in performance counters
+static int test_stats(void) {
+	printf("Running test_stats...\n");
+
+	const char *model_path = find_model_file("okay_nabu");
+	if (!model_path) {
+		printf("  SKIPPED: Model file not found\n");
+		return 0;
+	}
+
+	// A negative cutoff makes every inference a detection
+	MicroWakeWordConfig config = {
+		.model_path = model_path,
+		.libtensorflowlite_c = find_tflite_lib(),
+		.probability_cutoff = -1.0f,
+		.sliding_window_size = 1
+	};
+
+	size_t num_samples = 16000;
+	int16_t *samples = make_noise(num_samples);
+	MicroWakeWord *mww = micro_wakeword_create(&config);
+	MicroWakeWordFeatures *features = micro_wakeword_features_create();
+	if (!samples || !mww || !features) {
+		fprintf(stderr, "Failed to set up test\n");
+		micro_wakeword_features_destroy(features);
+		micro_wakeword_destroy(mww);
+		free(samples);
+		return 1;
+	}
+
+	const uint8_t *audio = (const uint8_t *)samples;
+	size_t audio_size = num_samples * sizeof(int16_t);
+	MicroWakeWordStats stats;
+	MicroWakeWordFeaturesStats features_stats;
+	int failed = 0;
+
+	// Nothing is collected until enabled
+	micro_wakeword_process_audio(mww, features, audio, 3200, NULL, 0);
+	if (micro_wakeword_get_stats(mww, &stats) != 0 ||
+	    micro_wakeword_features_get_stats(features, &features_stats) != 0 ||
+	    stats.frames != 0 || stats.invoke.count != 0 ||
+	    features_stats.audio_bytes != 0 || features_stats.frontend.count != 0) {
+		fprintf(stderr, "Counters changed while disabled\n");
+		failed = 1;
+	}
+
+	micro_wakeword_reset(mww);
+	micro_wakeword_features_reset(features);
+	micro_wakeword_enable_stats(mww, true);
+	micro_wakeword_features_enable_stats(features, true);
+
+	// Odd-sized packets leave audio in the backlog
+	int detections = 0;
+	for (size_t offset = 0; !failed && offset < audio_size; offset += 999) {
+		size_t size = audio_size - offset < 999 ? audio_size - offset : 999;
+		int result = micro_wakeword_process_audio(mww, features, audio + offset, size,
+							  NULL, 0);
+		if (result < 0) {
+			failed = 1;
+		}
+		detections += result;
+	}
+
+	micro_wakeword_get_stats(mww, &stats);
+	micro_wakeword_features_get_stats(features, &features_stats);
+	if (!failed &&
+	    (features_stats.audio_bytes != audio_size || features_stats.frames != 100 ||
+	     features_stats.frontend.count < features_stats.frames ||
+	     features_stats.buffered_bytes != 0 || features_stats.max_buffered_bytes == 0 ||
+	     features_stats.max_buffered_bytes >= 320 ||
+	     features_stats.frontend.max_ns > features_stats.frontend.total_ns)) {
+		fprintf(stderr, "Unexpected feature stats: %llu bytes, %llu frames\n",
+			(unsigned long long)features_stats.audio_bytes,
+			(unsigned long long)features_stats.frames);
+		failed = 1;
+	}
+
+	size_t stride = 3;  // okay_nabu input is [1, 3, 40]
+	if (!failed &&
+	    (stats.frames != 100 || stats.quantize.count != 100 ||
+	     stats.inferences != 100 / stride || stats.invoke.count != stats.inferences ||
+	     stats.detections != (uint64_t)detections ||
+	     stats.buffered_frames != 100 % stride || stats.invoke.total_ns == 0 ||
+	     stats.invoke.max_ns > stats.invoke.total_ns)) {
+		fprintf(stderr, "Unexpected detector stats: %llu frames, %llu inferences\n",
+			(unsigned long long)stats.frames, (unsigned long long)stats.inferences);
+		failed = 1;
+	}
+
+	micro_wakeword_reset(mww);
+	micro_wakeword_features_reset(features);
+	micro_wakeword_get_stats(mww, &stats);
+	micro_wakeword_features_get_stats(features, &features_stats);
+	if (!failed && (stats.resets != 1 || features_stats.resets != 1 ||
+			stats.buffered_frames != 0)) {
+		fprintf(stderr, "Resets not counted\n");
+		failed = 1;
+	}
+
+	// Disabling keeps the counters; enabling again clears them
+	micro_wakeword_enable_stats(mww, false);
+	micro_wakeword_process_audio(mww, features, audio, 3200, NULL, 0);
+	micro_wakeword_get_stats(mww, &stats);
+	if (!failed && stats.frames != 100) {
+		fprintf(stderr, "Counters changed while disabled\n");
+		failed = 1;
+	}
+	micro_wakeword_enable_stats(mww, true);
+	micro_wakeword_get_stats(mww, &stats);
+	if (!failed && (stats.frames != 0 || stats.resets != 0)) {
+		fprintf(stderr, "Counters not cleared when enabled\n");
+		failed = 1;
+	}
+
+	micro_wakeword_features_destroy(features);
+	micro_wakeword_destroy(mww);
+	free(samples);
+
+	if (failed) {
+		return 1;
+	}
+
+	printf("  test_stats: PASSED\n");
+	return 0;
+}
+
+// Test that the energy gate skips quiet windows without changing results on
+// the loud ones
+static int test_energy_gate(void) {
+	printf("Running test_energy_gate...\n");
+
+	const char *model_path = find_model_file("okay_nabu");
+	if (!model_path) {
+		printf("  SKIPPED: Model file not found\n");
+		return 0;
+	}
+
+	MicroWakeWordConfig config = {
+		.model_path = model_path,
+		.libtensorflowlite_c = find_tflite_lib(),
+		.probability_cutoff = 0.5f,
+		.sliding_window_size = 5
+	};
+
+	MicroWakeWord *reference = micro_wakeword_create(&config);
+	MicroWakeWord *gated = micro_wakeword_create(&config);
+	MicroWakeWordEnergyGate gate_config = { .threshold = 2.0f };
+	if (!reference || !gated || micro_wakeword_set_energy_gate(gated, &gate_config) != 0) {
+		fprintf(stderr, "Failed to create wake word detectors\n");
+		micro_wakeword_destroy(reference);
+		micro_wakeword_destroy(gated);
+		return 1;
+	}
+
+	// Quiet and loud segments: a gap shorter than the replay buffer, then a
+	// much longer one
+	const size_t segments[] = { 200, 300, 90, 150, 900, 300 };
+	uint32_t seed = 12345;
+	float frame[FEATURES_PER_WINDOW];
+	size_t frames = 0;
+	size_t compared = 0;
+	int failed = 0;
+
+	for (size_t s = 0; !failed && s < sizeof(segments) / sizeof(segments[0]); ++s) {
+		bool loud = (s % 2) == 1;
+		for (size_t n = 0; n < segments[s]; ++n, ++frames) {
+			for (size_t i = 0; i < FEATURES_PER_WINDOW; ++i) {
+				seed = seed * 1103515245u + 12345u;
+				frame[i] = loud ? (float)((seed >> 16) % 2600) / 100.0f
+						: 1.0f + (float)((seed >> 16) % 10) / 100.0f;
+			}
+
+			bool expected = micro_wakeword_process_streaming(reference, frame,
+									 FEATURES_PER_WINDOW);
+			bool detected = micro_wakeword_process_streaming(gated, frame,
+									 FEATURES_PER_WINDOW);
+			if (!loud) {
+				continue;
+			}
+
+			float expected_prob, expected_mean, prob, mean;
+			micro_wakeword_get_probabilities(reference, &expected_prob, &expected_mean);
+			micro_wakeword_get_probabilities(gated, &prob, &mean);
+			if (detected != expected || prob != expected_prob || mean != expected_mean) {
+				fprintf(stderr, "Frame %zu: expected %f (mean %f), got %f (mean %f)\n",
+					frames, expected_prob, expected_mean, prob, mean);
+				failed = 1;
+				break;
+			}
+			compared++;
+		}
+	}
+
+	MicroWakeWordEnergyGateStats stats;
+	if (!failed && micro_wakeword_get_energy_gate_stats(gated, &stats) != 0) {
+		fprintf(stderr, "Failed to get energy gate stats\n");
+		failed = 1;
+	}
+
+	// Quiet frames past the hangover are skipped; only the last 64 windows
+	// of the long gap are replayed
+	size_t quiet_windows = (200 + 90 + 900) / 3;
+	if (!failed && (stats.windows != frames / 3 || stats.skipped < quiet_windows / 2 ||
+			stats.replayed >= stats.skipped || stats.pending != 0 || !stats.open)) {
+		fprintf(stderr, "Unexpected gate stats: %llu windows, %llu skipped, %llu replayed\n",
+			(unsigned long long)stats.windows, (unsigned long long)stats.skipped,
+			(unsigned long long)stats.replayed);
+		failed = 1;
+	}
+
+	if (!failed && (micro_wakeword_set_energy_gate(gated, NULL) != 0 ||
+			micro_wakeword_get_energy_gate_stats(gated, &stats) == 0)) {
+		fprintf(stderr, "Failed to disable the energy gate\n");
+		failed = 1;
+	}
+
+	micro_wakeword_destroy(reference);
+	micro_wakeword_destroy(gated);
+
+	// A small preroll is raised to the sliding window, which is then refilled
+	// exactly after a gap of up to that many windows
+	config.sliding_window_size = 20;
+	reference = micro_wakeword_create(&config);
+	gated = micro_wakeword_create(&config);
+	MicroWakeWordEnergyGate small_gate = {
+		.threshold = 2.0f, .hangover_frames = 3, .preroll_windows = 4
+	};
+	if (!failed && (!reference || !gated ||
+			micro_wakeword_set_energy_gate(gated, &small_gate) != 0)) {
+		fprintf(stderr, "Failed to create wake word detectors\n");
+		failed = 1;
+	}
+	for (size_t n = 0; !failed && n < 90; ++n) {
+		bool loud = n >= 60;
+		for (size_t i = 0; i < FEATURES_PER_WINDOW; ++i) {
+			seed = seed * 1103515245u + 12345u;
+			frame[i] = loud ? (float)((seed >> 16) % 2600) / 100.0f
+					: 1.0f + (float)((seed >> 16) % 10) / 100.0f;
+		}
+		micro_wakeword_process_streaming(reference, frame, FEATURES_PER_WINDOW);
+		micro_wakeword_process_streaming(gated, frame, FEATURES_PER_WINDOW);
+		// Skipped windows are replayed when the first loud window completes
+		if (!loud || (n + 1) % 3 != 0) {
+			continue;
+		}
+
+		float expected_mean, mean;
+		size_t expected_count = micro_wakeword_get_probabilities(reference, NULL,
+									 &expected_mean);
+		size_t count = micro_wakeword_get_probabilities(gated, NULL, &mean);
+		if (count != expected_count || mean != expected_mean) {
+			fprintf(stderr, "Frame %zu: %zu probabilities (mean %f), expected %zu (%f)\n",
+				n, count, mean, expected_count, expected_mean);
+			failed = 1;
+		}
+	}
+	if (!failed && (micro_wakeword_get_energy_gate_stats(gated, &stats) != 0 ||
+			stats.replayed <= small_gate.preroll_windows)) {
+		fprintf(stderr, "Expected more than %zu windows replayed, got %llu\n",
+			small_gate.preroll_windows, (unsigned long long)stats.replayed);
+		failed = 1;
+	}
+	micro_wakeword_destroy(reference);
+	micro_wakeword_destroy(gated);
+
+	if (failed) {
+		return 1;
+	}
+
+	printf("  test_energy_gate: PASSED (%zu frames compared)\n", compared);
+	return 0;
+}
+
+// Largest probability difference allowed between a segmented scan and a
+// straight pass: the warm-up only approximates the frontend's adaptive state
+#define SCAN_PROBABILITY_TOLERANCE (4.0f / 256.0f)
+
+// Compare two detection lists, allowing probabilities to differ by tolerance
+static bool same_detections(const MicroWakeWordDetection *a, size_t count_a,
+			    const MicroWakeWordDetection *b, size_t count_b, float tolerance) {
+	if (count_a != count_b) {
+		return false;
+	}
+	for (size_t i = 0; i < count_a; ++i) {
+		if (a[i].sample_offset != b[i].sample_offset ||
+		    fabsf(a[i].probability - b[i].probability) > tolerance) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Write audio to a temporary file, behind a WAV header if wav is set
+static bool write_audio_file(char *path, const uint8_t *audio, size_t audio_size, bool wav) {
+	int fd = mkstemp(path);
+	if (fd < 0) {
+		return false;
+	}
+
+	uint8_t header[44];
+	uint32_t data_size = (uint32_t)audio_size;
+	uint32_t riff_size = data_size + 36;
+	uint32_t fmt_size = 16;
+	uint16_t format = 1, channels = 1, block_align = 2, bits = 16;
+	uint32_t sample_rate = 16000, byte_rate = 32000;
+	memcpy(header, "RIFF", 4);
+	memcpy(header + 4, &riff_size, 4);
+	memcpy(header + 8, "WAVEfmt ", 8);
+	memcpy(header + 16, &fmt_size, 4);
+	memcpy(header + 20, &format, 2);
+	memcpy(header + 22, &channels, 2);
+	memcpy(header + 24, &sample_rate, 4);
+	memcpy(header + 28, &byte_rate, 4);
+	memcpy(header + 32, &block_align, 2);
+	memcpy(header + 34, &bits, 2);
+	memcpy(header + 36, "data", 4);
+	memcpy(header + 40, &data_size, 4);
+
+	bool ok = (!wav || write(fd, header, sizeof(header)) == (ssize_t)sizeof(header)) &&
+		  write(fd, audio, audio_size) == (ssize_t)audio_size;
+	close(fd);
+	if (!ok) {
+		unlink(path);
+	}
+	return ok;
 }
 
-// Helper to find tensorflowlite_c library (for development only)
-// On installed systems, rely on system loader to find it in standard paths
-static const char *find_tflite_lib(void) {
-	// Only check relative paths for development builds
-	// On installed systems, return NULL to let system loader find it
-	const char *paths[] = {
-		"lib/linux_amd64/libtensorflowlite_c.so",
-		"lib/linux_arm64/libtensorflowlite_c.so",
-		"lib/linux_armv7/libtensorflowlite_c.so",
-		"../lib/linux_amd64/libtensorflowlite_c.so",
-		"../lib/linux_arm64/libtensorflowlite_c.so",
-		"../lib/linux_armv7/libtensorflowlite_c.so",
-		NULL
-	};
+#define TAP_INFERENCES 1000
 
-	for (size_t i = 0; paths[i]; ++i) {
-		FILE *f = fopen(paths[i], "r");
-		if (f) {
-			fclose(f);
-			return paths[i];
+// Drains a probability tap until told to stop
+typedef struct {
+	MicroWakeWord *mww;
+	MicroWakeWordProbability entries[TAP_INFERENCES];
+	size_t count;
+	int stop;
+} TapReader;
+
+static void *tap_reader_thread(void *arg) {
+	TapReader *reader = (TapReader *)arg;
+	for (;;) {
+		int stop = __atomic_load_n(&reader->stop, __ATOMIC_ACQUIRE);
+		reader->count += micro_wakeword_read_probabilities(
+			reader->mww, reader->entries + reader->count, TAP_INFERENCES - reader->count);
+		if (stop) {
+			break;
 		}
+		sched_yield();
 	}
-
-	// Return NULL to let system loader find it (dlopen will search LD_LIBRARY_PATH, /usr/lib, etc.)
 	return NULL;
 }
 
-// Test basic creation and destruction
-static int test_create_destroy(void) {
-	printf("Running test_create_destroy...\n");
+// Test that the probability tap records every model output in order,
+// drops and counts outputs when full, and can be drained from another
+// thread while the detector runs
+static int test_probability_tap(void) {
+	printf("Running test_probability_tap...\n");
 
 	const char *model_path = find_model_file("okay_nabu");
 	if (!model_path) {
@@ -75,39 +1966,192 @@ static int test_create_destroy(void) {
 		return 0;
 	}
 
-	const char *lib_path = find_tflite_lib();
-
 	MicroWakeWordConfig config = {
 		.model_path = model_path,
-		.libtensorflowlite_c = lib_path,
-		.probability_cutoff = 0.97f,
-		.sliding_window_size = 5
+		.libtensorflowlite_c = find_tflite_lib(),
+		.probability_cutoff = 0.5f,
+		.sliding_window_size = 1
 	};
 
 	MicroWakeWord *mww = micro_wakeword_create(&config);
-	if (!mww) {
-		fprintf(stderr, "Failed to create wake word detector\n");
+	TapReader *reader = (TapReader *)calloc(1, sizeof(TapReader));
+	float *probabilities = (float *)malloc(TAP_INFERENCES * sizeof(float));
+	uint64_t *offsets = (uint64_t *)malloc(TAP_INFERENCES * sizeof(uint64_t));
+	if (!mww || !reader || !probabilities || !offsets ||
+	    micro_wakeword_set_probability_tap(mww, 5) != 0) {
+		fprintf(stderr, "Failed to set up test\n");
+		micro_wakeword_destroy(mww);
+		free(reader);
+		free(probabilities);
+		free(offsets);
 		return 1;
 	}
 
+	int failed = 0;
+	float frame[FEATURES_PER_WINDOW];
+	MicroWakeWordResult result;
+	MicroWakeWordProbability entries[16];
+	MicroWakeWordProbabilityTapStats stats;
+	size_t inferences = 0;
+
+	// 20 outputs into a ring of 8 (5 rounded up), drained halfway
+	for (size_t pass = 0; !failed && pass < 2; ++pass) {
+		size_t first = inferences;
+		size_t start_allocs = alloc_count;
+		for (size_t n = 0; n < 30; ++n) {
+			for (size_t i = 0; i < FEATURES_PER_WINDOW; ++i) {
+				frame[i] = (float)((n * 7 + i * 3 + pass) % 26);
+			}
+			micro_wakeword_process_frame(mww, frame, FEATURES_PER_WINDOW, &result);
+			if (result.inferences == 1) {
+				probabilities[inferences] = result.probability;
+				offsets[inferences] = result.sample_offset;
+				inferences++;
+			}
+		}
+		if (alloc_count != start_allocs) {
+			fprintf(stderr, "Recording allocated memory\n");
+			failed = 1;
+		}
+
+		if (micro_wakeword_get_probability_tap_stats(mww, &stats) != 0 ||
+		    stats.capacity != 8 || stats.written != (pass + 1) * 8 ||
+		    stats.dropped != (pass + 1) * 2 || stats.pending != 8) {
+			fprintf(stderr, "Unexpected tap stats in pass %zu\n", pass);
+			failed = 1;
+		}
+
+		// The oldest 8 of each pass of 10 were kept
+		size_t count = micro_wakeword_read_probabilities(mww, entries, 3);
+		count += micro_wakeword_read_probabilities(mww, entries + count, 16 - count);
+		for (size_t i = 0; !failed && i < count; ++i) {
+			if (entries[i].sequence != first + i ||
+			    entries[i].sample_offset != offsets[first + i] ||
+			    entries[i].timestamp_ns == 0 ||
+			    (i > 0 && entries[i].timestamp_ns < entries[i - 1].timestamp_ns) ||
+			    entries[i].probability != probabilities[first + i]) {
+				fprintf(stderr, "Unexpected entry %zu in pass %zu\n", i, pass);
+				failed = 1;
+			}
+		}
+		if (!failed && (count != 8 || micro_wakeword_read_probabilities(mww, entries, 16) != 0)) {
+			fprintf(stderr, "Read %zu entries in pass %zu, expected 8\n", count, pass);
+			failed = 1;
+		}
+	}
+
+	// Outputs replayed by an energy gate get the positions of their windows
+	MicroWakeWordEnergyGate gate_config = { .threshold = 2.0f };
+	micro_wakeword_reset(mww);
+	if (!failed && (micro_wakeword_set_energy_gate(mww, &gate_config) != 0 ||
+			micro_wakeword_set_probability_tap(mww, 64) != 0)) {
+		fprintf(stderr, "Failed to set the energy gate and tap\n");
+		failed = 1;
+	}
+	uint32_t seed = 12345;
+	for (size_t n = 0; !failed && n < 150; ++n) {
+		for (size_t i = 0; i < FEATURES_PER_WINDOW; ++i) {
+			seed = seed * 1103515245u + 12345u;
+			frame[i] = n >= 120 ? (float)((seed >> 16) % 2600) / 100.0f
+					    : 1.0f + (float)((seed >> 16) % 10) / 100.0f;
+		}
+		micro_wakeword_process_streaming(mww, frame, FEATURES_PER_WINDOW);
+	}
+	MicroWakeWordEnergyGateStats gate_stats;
+	micro_wakeword_get_energy_gate_stats(mww, &gate_stats);
+	size_t count = 0;
+	while (!failed && count < 50) {
+		size_t read = micro_wakeword_read_probabilities(mww, reader->entries + count, 16);
+		if (read == 0) {
+			break;
+		}
+		count += read;
+	}
+	if (!failed && (gate_stats.replayed == 0 || count != 50)) {
+		fprintf(stderr, "Expected 50 entries with replays, got %zu\n", count);
+		failed = 1;
+	}
+	for (size_t i = 0; !failed && i < count; ++i) {
+		if (reader->entries[i].sample_offset != (i + 1) * 3 * SAMPLES_PER_CHUNK) {
+			fprintf(stderr, "Entry %zu is at sample %llu\n", i,
+				(unsigned long long)reader->entries[i].sample_offset);
+			failed = 1;
+		}
+	}
+	micro_wakeword_set_energy_gate(mww, NULL);
+
+	// Drained concurrently, every output is either read or dropped
+	micro_wakeword_reset(mww);
+	if (!failed && micro_wakeword_set_probability_tap(mww, 64) != 0) {
+		fprintf(stderr, "Failed to replace the tap\n");
+		failed = 1;
+	}
+	pthread_t thread;
+	reader->mww = mww;
+	reader->count = 0;
+	if (!failed && pthread_create(&thread, NULL, tap_reader_thread, reader) != 0) {
+		fprintf(stderr, "Failed to start reader thread\n");
+		failed = 1;
+	}
+	if (!failed) {
+		inferences = 0;
+		for (size_t n = 0; inferences < TAP_INFERENCES; ++n) {
+			for (size_t i = 0; i < FEATURES_PER_WINDOW; ++i) {
+				frame[i] = (float)((n * 11 + i * 5) % 26);
+			}
+			micro_wakeword_process_frame(mww, frame, FEATURES_PER_WINDOW, &result);
+			if (result.inferences == 1) {
+				probabilities[inferences] = result.probability;
+				offsets[inferences] = result.sample_offset;
+				inferences++;
+			}
+		}
+		__atomic_store_n(&reader->stop, 1, __ATOMIC_RELEASE);
+		pthread_join(thread, NULL);
+
+		micro_wakeword_get_probability_tap_stats(mww, &stats);
+		if (reader->count + stats.dropped != TAP_INFERENCES || stats.pending != 0) {
+			fprintf(stderr, "%zu read + %llu dropped, expected %d\n", reader->count,
+				(unsigned long long)stats.dropped, TAP_INFERENCES);
+			failed = 1;
+		}
+		for (size_t i = 0; !failed && i < reader->count; ++i) {
+			const MicroWakeWordProbability *entry = &reader->entries[i];
+			if (entry->sequence >= TAP_INFERENCES ||
+			    (i > 0 && entry->sequence <= reader->entries[i - 1].sequence) ||
+			    entry->probability != probabilities[entry->sequence] ||
+			    entry->sample_offset != offsets[entry->sequence]) {
+				fprintf(stderr, "Unexpected entry %zu read concurrently\n", i);
+				failed = 1;
+			}
+		}
+	}
+
+	// Removing the tap stops recording
+	micro_wakeword_set_probability_tap(mww, 0);
+	if (!failed && (micro_wakeword_get_probability_tap_stats(mww, &stats) == 0 ||
+			micro_wakeword_read_probabilities(mww, entries, 16) != 0)) {
+		fprintf(stderr, "Tap still active after removal\n");
+		failed = 1;
+	}
+
 	micro_wakeword_destroy(mww);
+	free(reader);
+	free(probabilities);
+	free(offsets);
 
-	// Test features
-	MicroWakeWordFeatures *features = micro_wakeword_features_create();
-	if (!features) {
-		fprintf(stderr, "Failed to create feature generator\n");
+	if (failed) {
 		return 1;
 	}
 
-	micro_wakeword_features_destroy(features);
-
-	printf("  test_create_destroy: PASSED\n");
+	printf("  test_probability_tap: PASSED\n");
 	return 0;
 }
 
-// Test reset functionality
-static int test_reset(void) {
-	printf("Running test_reset...\n");
+// Test that a default scan matches a straight pass exactly, and an opt-in
+// segmented scan within SCAN_PROBABILITY_TOLERANCE
+static int test_scan(void) {
+	printf("Running test_scan...\n");
 
 	const char *model_path = find_model_file("okay_nabu");
 	if (!model_path) {
@@ -115,47 +2159,100 @@ static int test_reset(void) {
 		return 0;
 	}
 
-	const char *lib_path = find_tflite_lib();
-
+	// A negative cutoff makes every inference a detection
 	MicroWakeWordConfig config = {
 		.model_path = model_path,
-		.libtensorflowlite_c = lib_path,
-		.probability_cutoff = 0.97f,
-		.sliding_window_size = 5
+		.libtensorflowlite_c = find_tflite_lib(),
+		.probability_cutoff = -1.0f,
+		.sliding_window_size = 3
 	};
 
+	// 20s of audio, plus a partial chunk
+	size_t num_samples = 20 * 16000 + 100;
+	int16_t *samples = make_noise(num_samples);
 	MicroWakeWord *mww = micro_wakeword_create(&config);
-	if (!mww) {
-		fprintf(stderr, "Failed to create wake word detector\n");
+	MicroWakeWordFeatures *features = micro_wakeword_features_create();
+	size_t max_detections = num_samples / 160;
+	MicroWakeWordDetection *expected = (MicroWakeWordDetection *)malloc(
+		max_detections * sizeof(MicroWakeWordDetection));
+	const uint8_t *audio = (const uint8_t *)samples;
+	size_t audio_size = num_samples * sizeof(int16_t);
+	int num_expected = -1;
+	if (samples && mww && features && expected) {
+		num_expected = micro_wakeword_process_audio(mww, features, audio, audio_size,
+							    expected, max_detections);
+	}
+	micro_wakeword_features_destroy(features);
+	micro_wakeword_destroy(mww);
+	if (num_expected <= 0) {
+		fprintf(stderr, "Failed to set up test\n");
+		free(expected);
+		free(samples);
 		return 1;
 	}
 
-	MicroWakeWordFeatures *features = micro_wakeword_features_create();
-	if (!features) {
-		micro_wakeword_destroy(mww);
-		return 1;
+	// By default the scan is one exact pass, whatever the thread count
+	MicroWakeWordScanOptions options = { .num_threads = 3 };
+	MicroWakeWordDetection *detections = NULL;
+	size_t num_detections = 0;
+	int failed = 0;
+
+	if (micro_wakeword_scan_audio(&config, audio, audio_size, &options, &detections,
+				      &num_detections) != 0 ||
+	    !same_detections(expected, (size_t)num_expected, detections, num_detections, 0.0f)) {
+		fprintf(stderr, "scan_audio: expected %d exact detections, got %zu\n",
+			num_expected, num_detections);
+		failed = 1;
 	}
+	free(detections);
 
-	// Process some dummy audio
-	uint8_t dummy_audio[320] = {0};
-	float *feature_array = NULL;
-	size_t feature_count = 0;
+	// Opting into five segments with the default warm-up. A negative cutoff
+	// reports every inference, so only probabilities can differ from the
+	// straight pass.
+	options.segment_seconds = 4.0f;
+	detections = NULL;
+	num_detections = 0;
+	if (!failed && (micro_wakeword_scan_audio(&config, audio, audio_size, &options,
+						  &detections, &num_detections) != 0 ||
+			!same_detections(expected, (size_t)num_expected, detections,
+					 num_detections, SCAN_PROBABILITY_TOLERANCE))) {
+		fprintf(stderr, "Segmented scan_audio: expected %d detections, got %zu\n",
+			num_expected, num_detections);
+		failed = 1;
+	}
+	free(detections);
 
-	micro_wakeword_features_process_streaming(features, dummy_audio,
-						  sizeof(dummy_audio),
-						  &feature_array, &feature_count);
-	if (feature_array) {
-		free(feature_array);
+	// The same audio from WAV and raw PCM files, with the default exact pass
+	for (int wav = 1; !failed && wav >= 0; --wav) {
+		char path[] = "/tmp/micro_wakeword_scan_XXXXXX";
+		if (!write_audio_file(path, audio, audio_size, wav)) {
+			fprintf(stderr, "Failed to write audio file\n");
+			failed = 1;
+			break;
+		}
+
+		detections = NULL;
+		num_detections = 0;
+		if (micro_wakeword_scan_file(&config, path, NULL, &detections,
+					     &num_detections) != 0 ||
+		    !same_detections(expected, (size_t)num_expected, detections, num_detections,
+				     0.0f)) {
+			fprintf(stderr, "scan_file (%s): expected %d detections, got %zu\n",
+				wav ? "WAV" : "raw", num_expected, num_detections);
+			failed = 1;
+		}
+		free(detections);
+		unlink(path);
 	}
 
-	// Reset
-	micro_wakeword_reset(mww);
-	micro_wakeword_features_reset(features);
+	free(expected);
+	free(samples);
 
-	micro_wakeword_destroy(mww);
-	micro_wakeword_features_destroy(features);
+	if (failed) {
+		return 1;
+	}
 
-	printf("  test_reset: PASSED\n");
+	printf("  test_scan: PASSED\n");
 	return 0;
 }
 
@@ -240,6 +2337,101 @@ static int test_process_wav(const char *model_name, const char *wav_path, bool s
 	return 0;
 }
 
+// Same as test_process_wav, through micro_wakeword_process_audio
+static int test_process_audio_wav(const char *model_name, const char *wav_path, bool should_detect) {
+	WavFile wav;
+	if (wav_file_read(wav_path, &wav) != 0) {
+		fprintf(stderr, "Failed to read WAV file: %s\n", wav_path);
+		return 1;
+	}
+
+	const char *model_path = find_model_file(model_name);
+	if (!model_path) {
+		wav_file_free(&wav);
+		return 1;
+	}
+
+	const char *lib_path = find_tflite_lib();
+
+	MicroWakeWordConfig config = {
+		.model_path = model_path,
+		.libtensorflowlite_c = lib_path,
+		.probability_cutoff = 0.97f,
+		.sliding_window_size = 5
+	};
+
+	MicroWakeWord *mww = micro_wakeword_create(&config);
+	if (!mww) {
+		fprintf(stderr, "Failed to create wake word detector\n");
+		wav_file_free(&wav);
+		return 1;
+	}
+
+	MicroWakeWordFeatures *features = micro_wakeword_features_create();
+	if (!features) {
+		micro_wakeword_destroy(mww);
+		wav_file_free(&wav);
+		return 1;
+	}
+
+	// Run the whole file through the fused PCM-to-detection path
+	uint8_t *audio_bytes = (uint8_t *)wav.data;
+	size_t audio_size = wav.data_size;
+
+	bool detected = micro_wakeword_process_audio(mww, features, audio_bytes, audio_size,
+						     NULL, 0) > 0;
+
+	micro_wakeword_destroy(mww);
+	micro_wakeword_features_destroy(features);
+	wav_file_free(&wav);
+
+	if (detected != should_detect) {
+		fprintf(stderr, "Expected detection=%d, got %d for %s\n",
+			should_detect, detected, wav_path);
+		return 1;
+	}
+
+	return 0;
+}
+
+// Count detections of a single stream processed sequentially, resetting
+// after each detection like the engine does
+static size_t count_detections(const MicroWakeWordConfig *config,
+			       const uint8_t *audio, size_t audio_size) {
+	MicroWakeWord *mww = micro_wakeword_create(config);
+	MicroWakeWordFeatures *features = micro_wakeword_features_create();
+	size_t detections = 0;
+	bool reset = config->refractory_ms == 0 && config->refractory_steps == 0 &&
+		     config->rearm_cutoff == 0.0f;
+
+	float *feature_array = NULL;
+	size_t feature_count = 0;
+	if (mww && features &&
+	    micro_wakeword_features_process_streaming(features, audio, audio_size,
+						      &feature_array, &feature_count) == 0) {
+		for (size_t i = 0; i + FEATURES_PER_WINDOW <= feature_count; i += FEATURES_PER_WINDOW) {
+			if (micro_wakeword_process_streaming(mww, &feature_array[i],
+							     FEATURES_PER_WINDOW)) {
+				detections++;
+				if (reset) {
+					micro_wakeword_reset(mww);
+				}
+			}
+		}
+		free(feature_array);
+	}
+
+	micro_wakeword_destroy(mww);
+	micro_wakeword_features_destroy(features);
+	return detections;
+}
+
+// Per-stream detection counter for the engine test
+static void on_engine_detection(MicroWakeWordStream *stream, void *user_data) {
+	(void)stream;
+	(*(size_t *)user_data)++;
+}
+
 // Helper to find WAV file (similar to Python's _DIR / model_name / f"{number}.wav")
 static const char *find_wav_file(const char *model_name, int number) {
 	static char wav_path[512];
@@ -314,12 +2506,163 @@ static int test_wav_files(void) {
 	return 0;
 }
 
+// Test the WAV files through micro_wakeword_process_audio
+static int test_wav_files_process_audio(void) {
+	printf("Running test_wav_files_process_audio...\n");
+
+	const char *models[] = {"okay_nabu", "hey_jarvis", "hey_mycroft", "alexa", NULL};
+	bool found_any = false;
+
+	for (size_t m = 0; models[m]; ++m) {
+		for (int num = 1; num <= 3; ++num) {
+			const char *wav_path = find_wav_file(models[m], num);
+			if (!wav_path) {
+				continue;
+			}
+			found_any = true;
+
+			// Positive with the same model, negative with one other model
+			const char *other = m == 0 ? models[1] : models[0];
+			if (test_process_audio_wav(models[m], wav_path, true) != 0 ||
+			    test_process_audio_wav(other, wav_path, false) != 0) {
+				fprintf(stderr, "Failed process_audio test for %s/%d.wav\n",
+					models[m], num);
+				return 1;
+			}
+		}
+	}
+
+	if (!found_any) {
+		printf("  SKIPPED: No WAV test files found\n");
+		return 0;
+	}
+
+	printf("  test_wav_files_process_audio: PASSED\n");
+	return 0;
+}
+
+// Test that the multi-stream engine matches sequential processing
+static int test_engine(void) {
+	printf("Running test_engine...\n");
+
+	const char *model_path = find_model_file("okay_nabu");
+	const char *wav_path = find_wav_file("okay_nabu", 1);
+	if (!model_path || !wav_path) {
+		printf("  SKIPPED: Model or WAV file not found\n");
+		return 0;
+	}
+
+	WavFile wav;
+	if (wav_file_read(wav_path, &wav) != 0) {
+		fprintf(stderr, "Failed to read WAV file: %s\n", wav_path);
+		return 1;
+	}
+
+	const char *lib_path = find_tflite_lib();
+
+	MicroWakeWordConfig configs[2] = {
+		{
+			.model_path = model_path,
+			.libtensorflowlite_c = lib_path,
+			.probability_cutoff = 0.97f,
+			.sliding_window_size = 5
+		}
+	};
+	// Streams with a refractory period keep running instead of resetting
+	configs[1] = configs[0];
+	configs[1].refractory_ms = 1000;
+
+	const uint8_t *audio = (const uint8_t *)wav.data;
+
+	int failed = 0;
+
+	for (size_t c = 0; c < 2 && !failed; ++c) {
+		const MicroWakeWordConfig config = configs[c];
+		size_t expected = count_detections(&config, audio, wav.data_size);
+
+		MicroWakeWordEngine *engine = micro_wakeword_engine_create(4);
+		if (!engine) {
+			fprintf(stderr, "Failed to create engine\n");
+			failed = 1;
+			break;
+		}
+
+		enum { NUM_STREAMS = 8 };
+		size_t detections[NUM_STREAMS] = {0};
+		MicroWakeWordStream *streams[NUM_STREAMS];
+
+		for (size_t s = 0; s < NUM_STREAMS; ++s) {
+			streams[s] = micro_wakeword_engine_add_stream(engine, &config,
+								      on_engine_detection,
+								      &detections[s]);
+			if (!streams[s]) {
+				fprintf(stderr, "Failed to add stream\n");
+				failed = 1;
+			}
+		}
+
+		// Interleave odd-sized packets across streams
+		for (size_t offset = 0; !failed && offset < wav.data_size; offset += 500) {
+			size_t size = wav.data_size - offset < 500 ? wav.data_size - offset : 500;
+			for (size_t s = 0; s < NUM_STREAMS; ++s) {
+				micro_wakeword_engine_push_audio(streams[s], audio + offset, size);
+			}
+		}
+
+		micro_wakeword_engine_flush(engine);
+
+		for (size_t s = 0; s < NUM_STREAMS && !failed; ++s) {
+			if (detections[s] != expected) {
+				fprintf(stderr, "Config %zu, stream %zu: expected %zu detections, got %zu\n",
+					c, s, expected, detections[s]);
+				failed = 1;
+			}
+		}
+
+		if (streams[0]) {
+			micro_wakeword_engine_remove_stream(streams[0]);
+		}
+		micro_wakeword_engine_destroy(engine);
+	}
+
+	wav_file_free(&wav);
+
+	if (failed) {
+		return 1;
+	}
+
+	printf("  test_engine: PASSED\n");
+	return 0;
+}
+
 int main(int argc, char *argv[]) {
 	int failures = 0;
 
 	failures += test_create_destroy();
+	failures += test_shared_runtime();
+	failures += test_shared_model();
+	failures += test_create_from_memory();
+	failures += test_concurrent_create();
 	failures += test_reset();
+	failures += test_reset_restores_state();
+	failures += test_interpreter_options();
+	failures += test_no_alloc_streaming();
+	failures += test_quantize_kernels();
+	failures += test_probability_window();
+	failures += test_features_into();
+	failures += test_features_callback();
+	failures += test_process_frame_results();
+	failures += test_refractory();
+	failures += test_process_audio();
+	failures += test_multi_model();
+	failures += test_multi_model_error();
+	failures += test_stats();
+	failures += test_energy_gate();
+	failures += test_probability_tap();
+	failures += test_scan();
 	failures += test_wav_files();
+	failures += test_wav_files_process_audio();
+	failures += test_engine();
 
 	if (failures == 0) {
 		printf("\nAll tests PASSED\n");
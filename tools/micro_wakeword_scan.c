@@ -0,0 +1,252 @@
+// tools/micro_wakeword_scan.c
+// Scans whole recordings for a wake word using every core
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include "micro_wakeword.h"
+
+#define SAMPLE_RATE 16000
+
+// Files shared by the worker threads
+typedef struct {
+	const MicroWakeWordConfig *config;
+	const MicroWakeWordScanOptions *options;
+	char **files;
+	size_t num_files;
+	pthread_mutex_t lock;  // Guards next, failures and output
+	size_t next;
+	int failures;
+} ScanJob;
+
+static double now_seconds(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Find the bundled TensorFlow Lite C library
+static const char *find_tflite_lib(void) {
+	const char *paths[] = {
+		"lib/linux_amd64/libtensorflowlite_c.so",
+		"lib/linux_arm64/libtensorflowlite_c.so",
+		"lib/linux_armv7/libtensorflowlite_c.so",
+		"../lib/linux_amd64/libtensorflowlite_c.so",
+		"../lib/linux_arm64/libtensorflowlite_c.so",
+		"../lib/linux_armv7/libtensorflowlite_c.so",
+		NULL
+	};
+
+	for (size_t i = 0; paths[i]; ++i) {
+		FILE *f = fopen(paths[i], "r");
+		if (f) {
+			fclose(f);
+			return paths[i];
+		}
+	}
+	return NULL;
+}
+
+// Read a number that follows "key": in a model's JSON manifest
+static bool json_number(const char *json, const char *key, double *value) {
+	char pattern[64];
+	snprintf(pattern, sizeof(pattern), "\"%s\"", key);
+	const char *p = strstr(json, pattern);
+	if (!p) {
+		return false;
+	}
+	p = strchr(p + strlen(pattern), ':');
+	if (!p) {
+		return false;
+	}
+	char *end;
+	*value = strtod(p + 1, &end);
+	return end != p + 1;
+}
+
+// Take the cutoff and window size from <model>.json next to the model
+static void load_model_config(const char *model_path, MicroWakeWordConfig *config) {
+	char json_path[1024];
+	snprintf(json_path, sizeof(json_path), "%s", model_path);
+	char *ext = strrchr(json_path, '.');
+	if (!ext || strchr(ext, '/')) {
+		return;
+	}
+	snprintf(ext, sizeof(json_path) - (size_t)(ext - json_path), ".json");
+
+	FILE *f = fopen(json_path, "r");
+	if (!f) {
+		return;
+	}
+	char json[4096];
+	size_t n = fread(json, 1, sizeof(json) - 1, f);
+	fclose(f);
+	json[n] = '\0';
+
+	double value;
+	if (json_number(json, "probability_cutoff", &value)) {
+		config->probability_cutoff = (float)value;
+	}
+	if (json_number(json, "sliding_window_size", &value) && value >= 1) {
+		config->sliding_window_size = (size_t)value;
+	}
+}
+
+// Scan one file and print its detections
+static int scan_one(ScanJob *job, const char *path) {
+	MicroWakeWordDetection *detections = NULL;
+	size_t num_detections = 0;
+	double start = now_seconds();
+	int status = micro_wakeword_scan_file(job->config, path, job->options, &detections,
+					      &num_detections);
+	double elapsed = now_seconds() - start;
+
+	pthread_mutex_lock(&job->lock);
+	if (status != 0) {
+		fprintf(stderr, "%s: scan failed (%d)\n", path, status);
+		job->failures++;
+	} else {
+		for (size_t d = 0; d < num_detections; ++d) {
+			printf("%s\t%.3f\t%.4f\n", path,
+			       (double)detections[d].sample_offset / SAMPLE_RATE,
+			       detections[d].probability);
+		}
+		fprintf(stderr, "%s: %zu detections in %.2fs\n", path, num_detections, elapsed);
+	}
+	pthread_mutex_unlock(&job->lock);
+
+	free(detections);
+	return status;
+}
+
+// Worker thread: scans one file at a time until none are left
+static void *scan_worker(void *arg) {
+	ScanJob *job = (ScanJob *)arg;
+
+	for (;;) {
+		pthread_mutex_lock(&job->lock);
+		size_t index = job->next++;
+		pthread_mutex_unlock(&job->lock);
+		if (index >= job->num_files) {
+			break;
+		}
+		scan_one(job, job->files[index]);
+	}
+	return NULL;
+}
+
+static void usage(const char *prog) {
+	fprintf(stderr,
+		"Usage: %s [-t threads] [-s segment_seconds] [-w warmup_seconds]\n"
+		"          [-c cutoff] [-n window] [-r refractory_ms] [-x]\n"
+		"          [-l libtensorflowlite_c.so]\n"
+		"          model.tflite file...\n"
+		"  Files are WAV (16-bit PCM, 16kHz, mono) or raw 16-bit PCM.\n"
+		"  The cutoff and window default to model.json next to the model.\n"
+		"  Files are scanned exactly, several at a time on the threads. -s splits\n"
+		"  each file into segments run on the threads instead (approximate).\n"
+		"  -r reports at most one detection per refractory_ms.\n"
+		"  Prints one line per detection: file, time in seconds, probability.\n",
+		prog);
+}
+
+int main(int argc, char *argv[]) {
+	MicroWakeWordConfig config = {
+		.probability_cutoff = 0.97f,
+		.sliding_window_size = 5
+	};
+	MicroWakeWordScanOptions options = { 0, 0.0f, 0.0f };
+	float cutoff = -1.0f;
+	size_t window = 0;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "t:s:w:c:n:r:xl:h")) != -1) {
+		switch (opt) {
+		case 't':
+			options.num_threads = (size_t)atoi(optarg);
+			break;
+		case 's':
+			options.segment_seconds = (float)atof(optarg);
+			break;
+		case 'w':
+			options.warmup_seconds = (float)atof(optarg);
+			break;
+		case 'c':
+			cutoff = (float)atof(optarg);
+			break;
+		case 'n':
+			window = (size_t)atoi(optarg);
+			break;
+		case 'r':
+			config.refractory_ms = (uint32_t)atoi(optarg);
+			break;
+		case 'x':
+			config.use_xnnpack = true;
+			break;
+		case 'l':
+			config.libtensorflowlite_c = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+	if (argc - optind < 2) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (!config.libtensorflowlite_c) {
+		config.libtensorflowlite_c = find_tflite_lib();
+	}
+	config.model_path = argv[optind];
+	load_model_config(config.model_path, &config);
+	if (cutoff >= 0.0f) {
+		config.probability_cutoff = cutoff;
+	}
+	if (window > 0) {
+		config.sliding_window_size = window;
+	}
+
+	size_t num_threads = options.num_threads;
+	if (num_threads == 0) {
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		num_threads = (cpus > 0) ? (size_t)cpus : 1;
+	}
+
+	ScanJob job = { &config, &options, argv + optind + 1, (size_t)(argc - optind - 1),
+			PTHREAD_MUTEX_INITIALIZER, 0, 0 };
+
+	// Segmented scans use the threads within each file, so take the files
+	// one at a time. Otherwise every file is one exact pass, and the files
+	// are spread over the threads.
+	if (options.segment_seconds > 0.0f) {
+		for (size_t i = 0; i < job.num_files; ++i) {
+			scan_one(&job, job.files[i]);
+		}
+	} else {
+		options.num_threads = 1;
+		if (num_threads > job.num_files) {
+			num_threads = job.num_files;
+		}
+		pthread_t *threads = (pthread_t *)calloc(num_threads, sizeof(pthread_t));
+		size_t started = 0;
+		for (; threads && started + 1 < num_threads; ++started) {
+			if (pthread_create(&threads[started], NULL, scan_worker, &job) != 0) {
+				break;
+			}
+		}
+		scan_worker(&job);
+		for (size_t i = 0; i < started; ++i) {
+			pthread_join(threads[i], NULL);
+		}
+		free(threads);
+	}
+
+	return job.failures ? 1 : 0;
+}
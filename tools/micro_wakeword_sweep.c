@@ -0,0 +1,561 @@
+// tools/micro_wakeword_sweep.c
+// Measures false accepts per hour and false rejection rate over a sweep of
+// probability cutoffs and sliding window sizes. Each file is run through the
+// model once, recording every inference's probability; the sweep replays
+// the detection rule on the recorded probabilities.
+
+#include <dirent.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "micro_wakeword.h"
+
+#define SAMPLE_RATE 16000
+#define MAX_PATH_LENGTH 1024
+
+// One model output
+typedef struct {
+	uint64_t sample_offset;  // Stream position at the end of the window
+	float probability;       // Raw model output
+} Inference;
+
+// Probability stream of one file
+typedef struct {
+	char path[MAX_PATH_LENGTH];
+	bool positive;
+	double seconds;
+	Inference *inferences;  // Every inference, in stream order
+	size_t num_inferences;
+	size_t capacity;
+	int status;
+} Recording;
+
+typedef struct {
+	Recording *items;
+	size_t count;
+	size_t capacity;
+} RecordingList;
+
+// Shared by the worker threads
+typedef struct {
+	const MicroWakeWordConfig *config;
+	RecordingList *recordings;
+	pthread_mutex_t lock;
+	size_t next;
+} RecordJob;
+
+// Per-worker detector and feature generator, and the file being recorded
+typedef struct {
+	MicroWakeWord *mww;
+	MicroWakeWordFeatures *features;
+	Recording *recording;
+} Recorder;
+
+// Find the bundled TensorFlow Lite C library
+static const char *find_tflite_lib(void) {
+	const char *paths[] = {
+		"lib/linux_amd64/libtensorflowlite_c.so",
+		"lib/linux_arm64/libtensorflowlite_c.so",
+		"lib/linux_armv7/libtensorflowlite_c.so",
+		"../lib/linux_amd64/libtensorflowlite_c.so",
+		"../lib/linux_arm64/libtensorflowlite_c.so",
+		"../lib/linux_armv7/libtensorflowlite_c.so",
+		NULL
+	};
+
+	for (size_t i = 0; paths[i]; ++i) {
+		FILE *f = fopen(paths[i], "r");
+		if (f) {
+			fclose(f);
+			return paths[i];
+		}
+	}
+	return NULL;
+}
+
+// Read a number that follows "key": in a model's JSON manifest
+static bool json_number(const char *json, const char *key, double *value) {
+	char pattern[64];
+	snprintf(pattern, sizeof(pattern), "\"%s\"", key);
+	const char *p = strstr(json, pattern);
+	if (!p) {
+		return false;
+	}
+	p = strchr(p + strlen(pattern), ':');
+	if (!p) {
+		return false;
+	}
+	char *end;
+	*value = strtod(p + 1, &end);
+	return end != p + 1;
+}
+
+// Current cutoff and window size from <model>.json next to the model
+static bool load_model_config(const char *model_path, float *cutoff, size_t *window) {
+	char json_path[MAX_PATH_LENGTH];
+	snprintf(json_path, sizeof(json_path), "%s", model_path);
+	char *ext = strrchr(json_path, '.');
+	if (!ext || strchr(ext, '/')) {
+		return false;
+	}
+	snprintf(ext, sizeof(json_path) - (size_t)(ext - json_path), ".json");
+
+	FILE *f = fopen(json_path, "r");
+	if (!f) {
+		return false;
+	}
+	char json[4096];
+	size_t n = fread(json, 1, sizeof(json) - 1, f);
+	fclose(f);
+	json[n] = '\0';
+
+	double c, w;
+	if (!json_number(json, "probability_cutoff", &c) ||
+	    !json_number(json, "sliding_window_size", &w) || w < 1) {
+		return false;
+	}
+	*cutoff = (float)c;
+	*window = (size_t)w;
+	return true;
+}
+
+static bool is_audio_file(const char *name) {
+	size_t len = strlen(name);
+	return (len > 4 && (strcmp(name + len - 4, ".wav") == 0 ||
+			    strcmp(name + len - 4, ".raw") == 0 ||
+			    strcmp(name + len - 4, ".pcm") == 0));
+}
+
+static int add_recording(RecordingList *list, const char *path, bool positive) {
+	if (list->count == list->capacity) {
+		size_t capacity = list->capacity ? list->capacity * 2 : 64;
+		Recording *items = (Recording *)realloc(list->items, capacity * sizeof(Recording));
+		if (!items) {
+			return -1;
+		}
+		list->items = items;
+		list->capacity = capacity;
+	}
+	Recording *recording = &list->items[list->count++];
+	memset(recording, 0, sizeof(*recording));
+	snprintf(recording->path, sizeof(recording->path), "%s", path);
+	recording->positive = positive;
+	return 0;
+}
+
+// Add a file, or every audio file under a directory
+static int add_path(RecordingList *list, const char *path, bool positive) {
+	struct stat st;
+	if (stat(path, &st) != 0) {
+		fprintf(stderr, "Cannot access %s\n", path);
+		return -1;
+	}
+	if (!S_ISDIR(st.st_mode)) {
+		return add_recording(list, path, positive);
+	}
+
+	DIR *dir = opendir(path);
+	if (!dir) {
+		return -1;
+	}
+	int status = 0;
+	struct dirent *entry;
+	while (status == 0 && (entry = readdir(dir))) {
+		if (entry->d_name[0] == '.') {
+			continue;
+		}
+		char child[MAX_PATH_LENGTH];
+		snprintf(child, sizeof(child), "%s/%s", path, entry->d_name);
+		if (stat(child, &st) != 0) {
+			continue;
+		}
+		if (S_ISDIR(st.st_mode)) {
+			status = add_path(list, child, positive);
+		} else if (is_audio_file(entry->d_name)) {
+			status = add_recording(list, child, positive);
+		}
+	}
+	closedir(dir);
+	return status;
+}
+
+static uint32_t read_le32(const uint8_t *p) {
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+	       ((uint32_t)p[3] << 24);
+}
+
+// Read a file into a malloc'd buffer and locate its 16-bit PCM audio: the
+// data chunk of a WAV file, or the whole file without a RIFF header
+// Returns 0 on success, negative on error
+static int read_audio(const char *path, uint8_t **file_out, size_t *offset, size_t *length) {
+	FILE *f = fopen(path, "rb");
+	if (!f) {
+		return -1;
+	}
+	long size = fseek(f, 0, SEEK_END) == 0 ? ftell(f) : -1;
+	uint8_t *file = size >= 0 ? (uint8_t *)malloc((size_t)size + 1) : NULL;
+	if (!file || fseek(f, 0, SEEK_SET) != 0 ||
+	    fread(file, 1, (size_t)size, f) != (size_t)size) {
+		free(file);
+		fclose(f);
+		return -1;
+	}
+	fclose(f);
+
+	*file_out = file;
+	*offset = 0;
+	*length = (size_t)size;
+	if ((size_t)size < 12 || memcmp(file, "RIFF", 4) != 0 || memcmp(file + 8, "WAVE", 4) != 0) {
+		return 0;
+	}
+
+	size_t pos = 12;
+	while (pos + 8 <= (size_t)size) {
+		size_t chunk_size = read_le32(file + pos + 4);
+		size_t available = (size_t)size - pos - 8;
+		if (memcmp(file + pos, "data", 4) == 0) {
+			*offset = pos + 8;
+			*length = chunk_size < available ? chunk_size : available;
+			return 0;
+		}
+		if (chunk_size > available) {
+			break;
+		}
+		pos += 8 + chunk_size + (chunk_size & 1);
+	}
+	return -2;
+}
+
+// Runs each frame through the detector and records the model's outputs
+static int record_frame(void *user_data, const float *frame, uint64_t end_sample) {
+	Recorder *recorder = (Recorder *)user_data;
+	Recording *recording = recorder->recording;
+
+	MicroWakeWordResult result;
+	int status = micro_wakeword_process_frame_at(recorder->mww, frame,
+						     MICRO_WAKEWORD_FEATURES_PER_FRAME,
+						     end_sample, &result);
+	if (status < 0) {
+		return status;
+	}
+	if (result.inferences == 0) {
+		return 0;
+	}
+
+	if (recording->num_inferences == recording->capacity) {
+		size_t capacity = recording->capacity ? recording->capacity * 2 : 1024;
+		Inference *inferences = (Inference *)realloc(recording->inferences,
+							     capacity * sizeof(Inference));
+		if (!inferences) {
+			return -10;
+		}
+		recording->inferences = inferences;
+		recording->capacity = capacity;
+	}
+	recording->inferences[recording->num_inferences++] =
+		(Inference){ result.sample_offset, result.probability };
+	return 0;
+}
+
+// Record one file's probability stream in a single straight pass
+static int record_file(Recorder *recorder) {
+	Recording *recording = recorder->recording;
+	uint8_t *file = NULL;
+	size_t offset, length;
+	int status = read_audio(recording->path, &file, &offset, &length);
+	if (status == 0) {
+		recording->seconds = (double)(length / 2) / SAMPLE_RATE;
+		micro_wakeword_reset(recorder->mww);
+		micro_wakeword_features_reset(recorder->features);
+		status = micro_wakeword_features_process_streaming_callback(
+			recorder->features, file + offset, length, record_frame, recorder);
+		if (status > 0) {
+			status = 0;
+		}
+	}
+	free(file);
+	return status;
+}
+
+// Worker thread: records the probability stream of one file at a time
+static void *record_worker(void *arg) {
+	RecordJob *job = (RecordJob *)arg;
+	Recorder recorder = {
+		micro_wakeword_create(job->config),
+		micro_wakeword_features_create(),
+		NULL
+	};
+
+	for (;;) {
+		pthread_mutex_lock(&job->lock);
+		size_t index = job->next++;
+		pthread_mutex_unlock(&job->lock);
+		if (index >= job->recordings->count) {
+			break;
+		}
+
+		recorder.recording = &job->recordings->items[index];
+		recorder.recording->status = (recorder.mww && recorder.features)
+					     ? record_file(&recorder) : -1;
+	}
+
+	micro_wakeword_features_destroy(recorder.features);
+	micro_wakeword_destroy(recorder.mww);
+	return NULL;
+}
+
+// Detections of one file under a cutoff and window size, replaying what the
+// detector would report. With no refractory_ms, refractory_steps or
+// rearm_cutoff in rules, each detection resets the detector, as the engine
+// does: the sliding window starts over, so the next detection needs window
+// new inferences (the replay cannot reset the model's own streaming state,
+// so the probabilities after it are those of a detector left running).
+// Otherwise the detector keeps running and holds back repeats by those
+// refractory and re-arm rules. Returns the number of accepts.
+static size_t count_accepts(const Recording *recording, const float *means, size_t window,
+			    float cutoff, const MicroWakeWordConfig *rules) {
+	bool reset = rules->refractory_ms == 0 && rules->refractory_steps == 0 &&
+		     rules->rearm_cutoff == 0.0f;
+	size_t accepts = 0;
+	bool armed = true;
+	uint64_t end_sample = 0;
+	size_t end_step = 0;
+	for (size_t i = window - 1; i < recording->num_inferences; ++i) {
+		if (!armed && means[i] <= rules->rearm_cutoff) {
+			armed = true;
+		}
+		if (!(means[i] > cutoff)) {
+			continue;
+		}
+		uint64_t offset = recording->inferences[i].sample_offset;
+		if (!armed || offset < end_sample || i + 1 < end_step) {
+			continue;
+		}
+		accepts++;
+		if (reset) {
+			end_step = i + 1 + window;
+			continue;
+		}
+		end_sample = offset + (uint64_t)rules->refractory_ms * SAMPLE_RATE / 1000;
+		end_step = i + 1 + rules->refractory_steps;
+		armed = !(rules->rearm_cutoff > 0.0f);
+	}
+	return accepts;
+}
+
+// Sliding window means of a recording's probabilities
+static void window_means(const Recording *recording, size_t window, float *means) {
+	double sum = 0.0;
+	for (size_t i = 0; i < recording->num_inferences; ++i) {
+		sum += recording->inferences[i].probability;
+		if (i >= window) {
+			sum -= recording->inferences[i - window].probability;
+		}
+		means[i] = (float)(sum / (double)(i + 1 < window ? i + 1 : window));
+	}
+}
+
+static void usage(const char *prog) {
+	fprintf(stderr,
+		"Usage: %s [-t threads] [-c min:max:step] [-w min:max] [-r refractory_ms]\n"
+		"          [-s refractory_steps] [-a rearm_cutoff] [-l libtensorflowlite_c.so]\n"
+		"          model.tflite -p positives... -n negatives...\n"
+		"  Positives and negatives are WAV/raw PCM files or directories of them.\n"
+		"  Prints CSV: window,cutoff,false_accepts,far_per_hour,missed,frr\n"
+		"  (default sweep: cutoffs 0.50:0.99:0.01, windows 1:10)\n"
+		"  By default each detection resets the detector, as the engine does.\n"
+		"  -r, -s and -a instead keep it running with the detector's refractory_ms,\n"
+		"  refractory_steps and rearm_cutoff; cutoffs not above rearm_cutoff are\n"
+		"  not swept, since the detector rejects them.\n",
+		prog);
+}
+
+int main(int argc, char *argv[]) {
+	size_t num_threads = 0;
+	float cutoff_min = 0.5f, cutoff_max = 0.99f, cutoff_step = 0.01f;
+	size_t window_min = 1, window_max = 10;
+	MicroWakeWordConfig rules = { .probability_cutoff = 0.0f };
+	const char *lib_path = NULL;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "+t:c:w:r:s:a:l:h")) != -1) {
+		switch (opt) {
+		case 't':
+			num_threads = (size_t)atoi(optarg);
+			break;
+		case 'c':
+			if (sscanf(optarg, "%f:%f:%f", &cutoff_min, &cutoff_max, &cutoff_step) != 3 ||
+			    cutoff_step <= 0.0f) {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'w':
+			if (sscanf(optarg, "%zu:%zu", &window_min, &window_max) != 2 ||
+			    window_min < 1 || window_max < window_min) {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'r':
+			rules.refractory_ms = (uint32_t)atoi(optarg);
+			break;
+		case 's':
+			rules.refractory_steps = (uint32_t)atoi(optarg);
+			break;
+		case 'a':
+			rules.rearm_cutoff = (float)atof(optarg);
+			if (rules.rearm_cutoff < 0.0f) {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'l':
+			lib_path = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+	if (optind >= argc) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	// Only the raw outputs are recorded; the detector's own decisions are unused
+	const char *model_path = argv[optind++];
+	MicroWakeWordConfig config = {
+		.model_path = model_path,
+		.libtensorflowlite_c = lib_path ? lib_path : find_tflite_lib(),
+		.probability_cutoff = 1.0f,
+		.sliding_window_size = 1
+	};
+
+	RecordingList recordings = { NULL, 0, 0 };
+	bool positive = true;
+	bool have_class = false;
+	for (int i = optind; i < argc; ++i) {
+		if (strcmp(argv[i], "-p") == 0 || strcmp(argv[i], "-n") == 0) {
+			positive = argv[i][1] == 'p';
+			have_class = true;
+			continue;
+		}
+		if (!have_class || add_path(&recordings, argv[i], positive) != 0) {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	// Record every file's probability stream once, in parallel
+	if (num_threads == 0) {
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		num_threads = (cpus > 0) ? (size_t)cpus : 1;
+	}
+	RecordJob job = { &config, &recordings, PTHREAD_MUTEX_INITIALIZER, 0 };
+	pthread_t *threads = (pthread_t *)calloc(num_threads, sizeof(pthread_t));
+	size_t started = 0;
+	for (; threads && started + 1 < num_threads; ++started) {
+		if (pthread_create(&threads[started], NULL, record_worker, &job) != 0) {
+			break;
+		}
+	}
+	record_worker(&job);
+	for (size_t i = 0; i < started; ++i) {
+		pthread_join(threads[i], NULL);
+	}
+	free(threads);
+
+	size_t num_positive = 0;
+	double negative_hours = 0.0;
+	size_t max_inferences = 0;
+	for (size_t i = 0; i < recordings.count; ++i) {
+		Recording *recording = &recordings.items[i];
+		if (recording->status != 0) {
+			fprintf(stderr, "Failed to process %s (%d)\n", recording->path, recording->status);
+			continue;
+		}
+		if (recording->positive) {
+			num_positive++;
+		} else {
+			negative_hours += recording->seconds / 3600.0;
+		}
+		if (recording->num_inferences > max_inferences) {
+			max_inferences = recording->num_inferences;
+		}
+	}
+	fprintf(stderr, "%zu positive files, %.3f hours of negatives\n", num_positive, negative_hours);
+
+	float current_cutoff = 0.0f;
+	size_t current_window = 0;
+	bool have_current = load_model_config(model_path, &current_cutoff, &current_window);
+
+	// The detector rejects a re-arm cutoff that is not below the cutoff, so
+	// the sweep starts at the first cutoff above it
+	while (rules.rearm_cutoff > 0.0f && cutoff_min <= rules.rearm_cutoff) {
+		cutoff_min += cutoff_step;
+	}
+	if (cutoff_min > cutoff_max + cutoff_step / 2) {
+		fprintf(stderr, "No cutoff in the sweep is above the re-arm cutoff\n");
+		return 1;
+	}
+
+	// Sweep: per window size, compute the means once and test every cutoff
+	size_t num_cutoffs = (size_t)((cutoff_max - cutoff_min) / cutoff_step + 1.5f);
+	size_t *false_accepts = (size_t *)malloc(num_cutoffs * sizeof(size_t));
+	size_t *missed = (size_t *)malloc(num_cutoffs * sizeof(size_t));
+	float *means = (float *)malloc((max_inferences ? max_inferences : 1) * sizeof(float));
+	if (!false_accepts || !missed || !means) {
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+
+	printf("window,cutoff,false_accepts,far_per_hour,missed,frr\n");
+	for (size_t window = window_min; window <= window_max; ++window) {
+		memset(false_accepts, 0, num_cutoffs * sizeof(size_t));
+		memset(missed, 0, num_cutoffs * sizeof(size_t));
+
+		for (size_t i = 0; i < recordings.count; ++i) {
+			const Recording *recording = &recordings.items[i];
+			if (recording->status != 0) {
+				continue;
+			}
+			window_means(recording, window, means);
+			for (size_t c = 0; c < num_cutoffs; ++c) {
+				float cutoff = cutoff_min + (float)c * cutoff_step;
+				size_t accepts = count_accepts(recording, means, window, cutoff,
+							       &rules);
+				if (recording->positive) {
+					missed[c] += accepts == 0;
+				} else {
+					false_accepts[c] += accepts;
+				}
+			}
+		}
+
+		for (size_t c = 0; c < num_cutoffs; ++c) {
+			float cutoff = cutoff_min + (float)c * cutoff_step;
+			printf("%zu,%.4f,%zu,%.4f,%zu,%.4f%s\n", window, cutoff, false_accepts[c],
+			       negative_hours > 0.0 ? (double)false_accepts[c] / negative_hours : 0.0,
+			       missed[c],
+			       num_positive ? (double)missed[c] / (double)num_positive : 0.0,
+			       have_current && window == current_window &&
+			       cutoff > current_cutoff - cutoff_step / 2 &&
+			       cutoff < current_cutoff + cutoff_step / 2 ? ",current" : "");
+		}
+	}
+
+	free(false_accepts);
+	free(missed);
+	free(means);
+	for (size_t i = 0; i < recordings.count; ++i) {
+		free(recordings.items[i].inferences);
+	}
+	free(recordings.items);
+	return 0;
+}